@@ -0,0 +1,792 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <SerialTwoWire.h>
+#include <util/twi.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+using namespace Simulator;
+
+// registers
+
+volatile uint8_t PINB;
+volatile uint8_t DDRB;
+volatile uint8_t PORTB;
+volatile uint8_t PINC;
+volatile uint8_t DDRC;
+volatile uint8_t PORTC;
+volatile uint8_t PIND;
+volatile uint8_t DDRD;
+volatile uint8_t PORTD;
+
+static constexpr uint16_t kTimer1Prescalers[8] = { 0, 1, 8, 64, 256, 1024, 0, 0 };
+static constexpr uint16_t kTimer2Prescalers[8] = { 0, 1, 8, 32, 64, 128, 256, 1024 };
+
+namespace Simulator {
+
+    cycles_t cycles;
+    Cpu cpu;
+    Timer timer1 = { 0x10000, 0, 0, 0 };
+    Timer timer2 = { 0x100, 0, 0, 0 };
+    uint16_t adc_values[16];
+    uint16_t isr_overhead_cycles = 20;
+    uint16_t main_call_cycles = 50;
+    VectorStats vector_stats[static_cast<uint8_t>(Vector::kSize)];
+
+    void (*on_port_change)(uint8_t port, uint8_t previous, uint8_t current);
+    void (*on_serial_write)(const uint8_t *buffer, size_t size);
+    void (*on_i2c_master_transmit)(uint8_t address, const uint8_t *buffer, size_t size);
+    void (*on_i2c_slave_transmit)(const uint8_t *buffer, size_t size);
+
+}
+
+uint8_t TCCR1A;
+ClockSelectRegister TCCR1B = { timer1, kTimer1Prescalers, 0 };
+CounterRegister TCNT1 = { timer1 };
+volatile uint16_t OCR1A;
+volatile uint16_t OCR1B;
+volatile uint16_t ICR1;
+volatile uint8_t TIMSK1;
+FlagRegister TIFR1;
+
+uint8_t TCCR2A;
+ClockSelectRegister TCCR2B = { timer2, kTimer2Prescalers, 0 };
+CounterRegister TCNT2 = { timer2 };
+volatile uint8_t TIMSK2;
+FlagRegister TIFR2;
+
+volatile uint8_t EICRA;
+volatile uint8_t EIMSK;
+volatile uint8_t EIFR;
+
+volatile uint8_t ADMUX;
+AdcControlRegister ADCSRA;
+volatile uint8_t ADCSRB;
+
+volatile uint8_t TWBR;
+volatile uint8_t TWSR;
+volatile uint8_t TWAR;
+volatile uint8_t TWDR;
+volatile uint8_t TWAMR;
+TwiControlRegister TWCR;
+
+volatile uint8_t SPMCSR;
+
+HardwareSerial Serial;
+#if SERIAL_I2C_BRIDGE ? !DIMMER_SERIAL_BINARY_FRAMES : !DIMMER_HAVE_TWI_SLAVE
+SerialTwoWire Wire;
+#endif
+EEPROMClass EEPROM;
+
+// unused vectors
+
+extern "C" {
+
+    __attribute__((weak)) void TIMER1_CAPT_vect() {}
+    __attribute__((weak)) void TIMER1_COMPA_vect() {}
+    __attribute__((weak)) void TIMER1_COMPB_vect() {}
+    __attribute__((weak)) void TIMER1_OVF_vect() {}
+    __attribute__((weak)) void TIMER2_OVF_vect() {}
+    __attribute__((weak)) void TWI_vect() {}
+
+}
+
+static void (*ext_int_handler[2])();
+
+static void int0_vect()
+{
+    if (ext_int_handler[0]) {
+        ext_int_handler[0]();
+    }
+}
+
+static void int1_vect()
+{
+    if (ext_int_handler[1]) {
+        ext_int_handler[1]();
+    }
+}
+
+struct VectorInfo {
+    const char *name;
+    void (*handler)();
+    volatile uint8_t &flags;
+    uint8_t flag;
+    volatile uint8_t &mask;
+    uint8_t enable;
+    // the flag is cleared when the vector is called
+    bool clear{true};
+};
+
+static const VectorInfo vectors[static_cast<uint8_t>(Vector::kSize)] = {
+    { "INT0", int0_vect, EIFR, _BV(0), EIMSK, _BV(0) },
+    { "INT1", int1_vect, EIFR, _BV(1), EIMSK, _BV(1) },
+    { "TIMER2_OVF", TIMER2_OVF_vect, TIFR2.value, _BV(TOV2), TIMSK2, _BV(TOIE2) },
+    { "TIMER1_CAPT", TIMER1_CAPT_vect, TIFR1.value, _BV(ICF1), TIMSK1, _BV(ICIE1) },
+    { "TIMER1_COMPA", TIMER1_COMPA_vect, TIFR1.value, _BV(OCF1A), TIMSK1, _BV(OCIE1A) },
+    { "TIMER1_COMPB", TIMER1_COMPB_vect, TIFR1.value, _BV(OCF1B), TIMSK1, _BV(OCIE1B) },
+    { "TIMER1_OVF", TIMER1_OVF_vect, TIFR1.value, _BV(TOV1), TIMSK1, _BV(TOIE1) },
+    { "TWI", TWI_vect, TWCR.value, _BV(TWINT), TWCR.value, _BV(TWIE), false },
+};
+
+static Source *source;
+
+// timers
+
+uint32_t Timer::count() const
+{
+    if (!prescaler) {
+        return base;
+    }
+    return (base + (cycles - start) / prescaler) % top;
+}
+
+CounterRegister::operator uint16_t() const
+{
+    run_for(2);
+    return timer.count();
+}
+
+void Timer::set_count(uint32_t value)
+{
+    base = value % top;
+    start = cycles;
+}
+
+void Timer::set_prescaler(uint16_t value)
+{
+    base = count();
+    start = cycles;
+    prescaler = value;
+}
+
+cycles_t Timer::next(uint32_t value) const
+{
+    if (!prescaler) {
+        return kNever;
+    }
+    auto elapsed = (cycles - start) / prescaler;
+    auto current = (base + elapsed) % top;
+    auto diff = (value + top - current) % top;
+    if (diff == 0) {
+        diff = top;
+    }
+    return start + (elapsed + diff) * prescaler;
+}
+
+// scheduler
+
+namespace Simulator {
+
+    struct NextEvents {
+        cycles_t timer1_overflow;
+        cycles_t timer1_compare_a;
+        cycles_t timer1_compare_b;
+        cycles_t timer2_overflow;
+        cycles_t twi;
+        cycles_t source;
+    };
+
+    static cycles_t twi_next_event();
+    static void twi_event();
+
+    static cycles_t get_next_events(NextEvents &next)
+    {
+        next.timer1_overflow = timer1.next(0);
+        next.timer1_compare_a = timer1.next(OCR1A);
+        next.timer1_compare_b = timer1.next(OCR1B);
+        next.timer2_overflow = timer2.next(0);
+        next.twi = twi_next_event();
+        next.source = source ? source->next_event() : kNever;
+        return std::min({ next.timer1_overflow, next.timer1_compare_a, next.timer1_compare_b, next.timer2_overflow, next.twi, next.source });
+    }
+
+    static void latch_events(const NextEvents &next)
+    {
+        if (next.timer1_overflow == cycles) {
+            TIFR1.value |= _BV(TOV1);
+        }
+        if (next.timer1_compare_a == cycles) {
+            TIFR1.value |= _BV(OCF1A);
+        }
+        if (next.timer1_compare_b == cycles) {
+            TIFR1.value |= _BV(OCF1B);
+        }
+        if (next.timer2_overflow == cycles) {
+            TIFR2.value |= _BV(TOV2);
+        }
+        if (next.twi == cycles) {
+            twi_event();
+        }
+        if (next.source == cycles) {
+            source->event();
+        }
+    }
+
+    // advance clock without executing any interrupts
+    static void tick(cycles_t until)
+    {
+        NextEvents next;
+        cycles_t time;
+        while ((time = get_next_events(next)) <= until) {
+            cycles = time;
+            latch_events(next);
+        }
+        cycles = until;
+    }
+
+    static void dispatch_pending()
+    {
+        while (cpu.interrupts) {
+            auto vector = std::find_if(std::begin(vectors), std::end(vectors), [](const VectorInfo &info) {
+                return (info.flags & info.flag) && (info.mask & info.enable);
+            });
+            if (vector == std::end(vectors)) {
+                break;
+            }
+            if (vector->clear) {
+                vector->flags &= ~vector->flag;
+            }
+            cpu.disable_interrupts();
+            cpu.isr_level++;
+
+            tick(cycles + isr_overhead_cycles);
+
+            auto start = std::chrono::steady_clock::now();
+            vector->handler();
+            uint64_t nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+            auto &stats = vector_stats[vector - std::begin(vectors)];
+            stats.count++;
+            stats.host_nanos += nanos;
+            stats.host_nanos_max = std::max(stats.host_nanos_max, nanos);
+
+            check_ports();
+            cpu.isr_level--;
+            cpu.enable_interrupts();
+        }
+    }
+
+    void advance(cycles_t until)
+    {
+        if (cpu.in_isr()) {
+            tick(std::max(until, cycles));
+            return;
+        }
+        NextEvents next;
+        for(;;) {
+            dispatch_pending();
+            auto time = get_next_events(next);
+            if (time > until) {
+                break;
+            }
+            cycles = time;
+            latch_events(next);
+        }
+        cycles = std::max(until, cycles);
+    }
+
+    void set_source(Source *newSource)
+    {
+        source = newSource;
+    }
+
+    void set_pin(uint8_t pin, bool level)
+    {
+        auto port = portInputRegister(digitalPinToPort(pin));
+        auto mask = digitalPinToBitMask(pin);
+        bool previous = (*port & mask) != 0;
+        if (previous == level) {
+            return;
+        }
+        if (level) {
+            *port |= mask;
+        }
+        else {
+            *port &= ~mask;
+        }
+        auto num = digitalPinToInterrupt(pin);
+        if (num != NOT_AN_INTERRUPT) {
+            auto mode = (EICRA >> (num * 2)) & 0x03;
+            if (mode == CHANGE || (mode == RISING && level) || (mode == FALLING && !level)) {
+                EIFR |= _BV(num);
+            }
+        }
+        // input capture unit of timer 1 on ICP1 (PB0), the delay of the noise canceler is not simulated
+        if (pin == 8 && (TCCR1B & 0x07) && level == ((TCCR1B & _BV(ICES1)) != 0)) {
+            ICR1 = timer1.count();
+            TIFR1.value |= _BV(ICF1);
+        }
+    }
+
+    void check_ports()
+    {
+        static uint8_t last[3];
+        uint8_t current[3] = { PORTB, PORTC, PORTD };
+        for(uint8_t i = 0; i < 3; i++) {
+            if (current[i] != last[i]) {
+                if (on_port_change) {
+                    on_port_change(PB + i, last[i], current[i]);
+                }
+                last[i] = current[i];
+            }
+        }
+    }
+
+    uint16_t adc_read()
+    {
+        return adc_values[ADMUX & 0x0f] & 0x3ff;
+    }
+
+    const char *get_vector_name(Vector vector)
+    {
+        return vectors[static_cast<uint8_t>(vector)].name;
+    }
+
+}
+
+// TWI
+//
+// the bus is shared by the firmware and the transactions queued by the simulator, which acts as the other
+// master. each byte takes 9 clock cycles of the bus. arbitration, repeated start and clock stretching by the
+// master are not simulated
+
+namespace Simulator {
+
+    static constexpr cycles_t kTwiBitCycles = F_CPU / 100000;
+    static constexpr cycles_t kTwiByteCycles = kTwiBitCycles * 9;
+
+    struct TwiTransaction {
+        uint8_t address;
+        bool read;
+        uint8_t length;
+        std::vector<uint8_t> data;
+    };
+
+    enum class TwiState : uint8_t {
+        kIdle,
+        kSlaveReceiver,
+        kSlaveTransmitter,
+        kMasterStart,
+        kMasterAddress,
+        kMasterTransmitter,
+    };
+
+    static struct {
+        TwiState state;
+        bool start;
+        bool ack;
+        cycles_t next = kNever;
+        std::deque<TwiTransaction> queue;
+        TwiTransaction current;
+        size_t pos;
+        uint8_t master_address;
+        std::vector<uint8_t> master_data;
+        unsigned master_nack;
+    } twi;
+
+    void twi_nack_master(unsigned count)
+    {
+        twi.master_nack = count;
+    }
+
+    void twi_queue_write(uint8_t address, const uint8_t *buffer, size_t size)
+    {
+        twi.queue.push_back({ address, false, 0, std::vector<uint8_t>(buffer, buffer + size) });
+    }
+
+    void twi_queue_read(uint8_t address, uint8_t length)
+    {
+        twi.queue.push_back({ address, true, length, {} });
+    }
+
+    static void twi_set_status(uint8_t status)
+    {
+        TWSR = (TWSR & ~TW_STATUS_MASK) | status;
+        TWCR.value |= _BV(TWINT);
+    }
+
+    static cycles_t twi_next_event()
+    {
+        // start the next transaction when the bus is free
+        if (twi.next == kNever && twi.state == TwiState::kIdle && (TWCR.value & _BV(TWEN)) && !(TWCR.value & _BV(TWINT))) {
+            if (twi.start) {
+                twi.next = cycles + kTwiBitCycles;
+            }
+            else if (!twi.queue.empty()) {
+                twi.next = cycles + kTwiByteCycles;
+            }
+        }
+        return twi.next;
+    }
+
+    static void twi_event()
+    {
+        twi.next = kNever;
+        switch(twi.state) {
+            case TwiState::kIdle:
+                if (twi.start) {
+                    twi.start = false;
+                    twi.state = TwiState::kMasterStart;
+                    twi_set_status(TW_START);
+                }
+                else {
+                    twi.current = std::move(twi.queue.front());
+                    twi.queue.pop_front();
+                    twi.pos = 0;
+                    auto address = twi.current.address;
+                    bool generalCall = address == 0 && (TWAR & _BV(TWGCE)) && !twi.current.read;
+                    if (!(TWCR.value & _BV(TWEA)) || (address != (TWAR >> 1) && !generalCall)) {
+                        // no ACK for the address
+                        break;
+                    }
+                    if (twi.current.read) {
+                        twi.state = TwiState::kSlaveTransmitter;
+                        twi_set_status(TW_ST_SLA_ACK);
+                    }
+                    else {
+                        twi.state = TwiState::kSlaveReceiver;
+                        twi_set_status(generalCall ? TW_SR_GCALL_ACK : TW_SR_SLA_ACK);
+                    }
+                }
+                break;
+            case TwiState::kSlaveReceiver:
+                if (twi.pos < twi.current.data.size()) {
+                    bool generalCall = twi.current.address == 0;
+                    TWDR = twi.current.data[twi.pos++];
+                    if (twi.ack) {
+                        twi_set_status(generalCall ? TW_SR_GCALL_DATA_ACK : TW_SR_DATA_ACK);
+                    }
+                    else {
+                        twi_set_status(generalCall ? TW_SR_GCALL_DATA_NACK : TW_SR_DATA_NACK);
+                    }
+                }
+                else {
+                    twi_set_status(TW_SR_STOP);
+                }
+                break;
+            case TwiState::kSlaveTransmitter:
+                twi.current.data.push_back(static_cast<uint8_t>(TWDR));
+                if (twi.current.data.size() >= twi.current.length) {
+                    twi_set_status(TW_ST_DATA_NACK);
+                }
+                else {
+                    twi_set_status(twi.ack ? TW_ST_DATA_ACK : TW_ST_LAST_DATA);
+                }
+                break;
+            case TwiState::kMasterAddress:
+                if (twi.master_nack) {
+                    // the state does not change until the stop condition
+                    twi.master_nack--;
+                    twi_set_status(TW_MT_SLA_NACK);
+                    break;
+                }
+                twi.master_address = TWDR >> 1;
+                twi.master_data.clear();
+                twi.state = TwiState::kMasterTransmitter;
+                twi_set_status(TW_MT_SLA_ACK);
+                break;
+            case TwiState::kMasterTransmitter:
+                twi.master_data.push_back(static_cast<uint8_t>(TWDR));
+                twi_set_status(TW_MT_DATA_ACK);
+                break;
+            default:
+                break;
+        }
+    }
+
+    // TWINT has been cleared
+    static void twi_control()
+    {
+        auto status = TWSR & TW_STATUS_MASK;
+        if (TWCR.value & _BV(TWSTO)) {
+            if (twi.state == TwiState::kMasterTransmitter && on_i2c_master_transmit) {
+                on_i2c_master_transmit(twi.master_address, twi.master_data.data(), twi.master_data.size());
+            }
+            TWCR.value &= ~_BV(TWSTO);
+            twi.state = TwiState::kIdle;
+            twi.next = kNever;
+            return;
+        }
+        switch(twi.state) {
+            case TwiState::kIdle:
+                if (TWCR.value & _BV(TWSTA)) {
+                    twi.start = true;
+                }
+                break;
+            case TwiState::kSlaveReceiver:
+                if (status == TW_SR_STOP || status == TW_SR_DATA_NACK || status == TW_SR_GCALL_DATA_NACK) {
+                    // the master sends a stop condition after a NACK
+                    twi.state = TwiState::kIdle;
+                }
+                else {
+                    twi.ack = TWCR.value & _BV(TWEA);
+                    twi.next = cycles + (twi.pos < twi.current.data.size() ? kTwiByteCycles : kTwiBitCycles);
+                }
+                break;
+            case TwiState::kSlaveTransmitter:
+                if (status == TW_ST_DATA_NACK || status == TW_ST_LAST_DATA) {
+                    // the slave does not drive the bus after the last byte
+                    twi.current.data.resize(twi.current.length, 0xff);
+                    if (on_i2c_slave_transmit) {
+                        on_i2c_slave_transmit(twi.current.data.data(), twi.current.data.size());
+                    }
+                    twi.state = TwiState::kIdle;
+                }
+                else {
+                    twi.ack = TWCR.value & _BV(TWEA);
+                    twi.next = cycles + kTwiByteCycles;
+                }
+                break;
+            case TwiState::kMasterStart:
+                twi.state = TwiState::kMasterAddress;
+                twi.next = cycles + kTwiByteCycles;
+                break;
+            case TwiState::kMasterTransmitter:
+                twi.next = cycles + kTwiByteCycles;
+                break;
+            default:
+                break;
+        }
+    }
+
+    TwiControlRegister::operator uint8_t() const
+    {
+        // polling TWINT
+        if (!(value & _BV(TWINT)) && (twi.state != TwiState::kIdle || twi.start)) {
+            run_for(8);
+        }
+        return value;
+    }
+
+    TwiControlRegister &TwiControlRegister::operator=(uint8_t newValue)
+    {
+        bool clear = newValue & _BV(TWINT);
+        value = (newValue & ~_BV(TWINT)) | (clear ? 0 : (value & _BV(TWINT)));
+        if (!(value & _BV(TWEN))) {
+            twi.state = TwiState::kIdle;
+            twi.start = false;
+            twi.next = kNever;
+        }
+        else if (clear) {
+            twi_control();
+        }
+        return *this;
+    }
+
+}
+
+// Arduino API
+
+uint32_t millis()
+{
+    run_for(main_call_cycles);
+    return cycles / (F_CPU / 1000);
+}
+
+uint32_t micros()
+{
+    run_for(main_call_cycles);
+    return cycles / (F_CPU / 1000000);
+}
+
+void delay(uint32_t ms)
+{
+    run_for(static_cast<cycles_t>(ms) * (F_CPU / 1000));
+}
+
+void delayMicroseconds(unsigned int us)
+{
+    run_for(static_cast<cycles_t>(us) * (F_CPU / 1000000));
+}
+
+void yield()
+{
+    run_for(main_call_cycles);
+}
+
+void optimistic_yield(uint32_t)
+{
+    yield();
+}
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    auto port = digitalPinToPort(pin);
+    if (port == NOT_A_PORT) {
+        return;
+    }
+    auto mask = digitalPinToBitMask(pin);
+    if (mode == OUTPUT) {
+        *portModeRegister(port) |= mask;
+    }
+    else {
+        *portModeRegister(port) &= ~mask;
+        if (mode == INPUT_PULLUP) {
+            *portOutputRegister(port) |= mask;
+        }
+        else {
+            *portOutputRegister(port) &= ~mask;
+        }
+    }
+    check_ports();
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    auto port = digitalPinToPort(pin);
+    if (port == NOT_A_PORT) {
+        return;
+    }
+    if (val) {
+        *portOutputRegister(port) |= digitalPinToBitMask(pin);
+    }
+    else {
+        *portOutputRegister(port) &= ~digitalPinToBitMask(pin);
+    }
+    check_ports();
+}
+
+int digitalRead(uint8_t pin)
+{
+    auto port = digitalPinToPort(pin);
+    if (port == NOT_A_PORT) {
+        return LOW;
+    }
+    return (*portInputRegister(port) & digitalPinToBitMask(pin)) ? HIGH : LOW;
+}
+
+int analogRead(uint8_t pin)
+{
+    if (pin >= A0) {
+        pin -= A0;
+    }
+    return adc_values[pin & 0x07] & 0x3ff;
+}
+
+void analogReference(uint8_t)
+{
+}
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode)
+{
+    if (interruptNum < 2) {
+        ext_int_handler[interruptNum] = userFunc;
+        EICRA = (EICRA & ~(0x03 << (interruptNum * 2))) | (mode << (interruptNum * 2));
+        EIMSK |= _BV(interruptNum);
+    }
+}
+
+void detachInterrupt(uint8_t interruptNum)
+{
+    if (interruptNum < 2) {
+        EIMSK &= ~_BV(interruptNum);
+        ext_int_handler[interruptNum] = nullptr;
+    }
+}
+
+#if !SERIAL_I2C_BRIDGE || !DIMMER_SERIAL_BINARY_FRAMES
+
+// I2C over UART is processed here instead of reading the serial port
+void serialEvent()
+{
+#if SERIAL_I2C_BRIDGE || !DIMMER_HAVE_TWI_SLAVE
+    Wire._processQueue();
+#endif
+}
+
+#endif
+
+// Print
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t count = 0;
+    while (size--) {
+        count += write(*buffer++);
+    }
+    return count;
+}
+
+size_t Print::print(long value, int base)
+{
+    if (base == DEC) {
+        char buf[24];
+        snprintf(buf, sizeof(buf), "%ld", value);
+        return write(buf);
+    }
+    return print(static_cast<unsigned long>(value), base);
+}
+
+size_t Print::print(unsigned long value, int base)
+{
+    char buf[sizeof(value) * 8 + 1];
+    auto ptr = &buf[sizeof(buf) - 1];
+    *ptr = 0;
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        auto digit = value % base;
+        *--ptr = digit < 10 ? digit + '0' : digit + 'A' - 10;
+        value /= base;
+    } while (value);
+    return write(ptr);
+}
+
+size_t Print::print(double value, int digits)
+{
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%.*f", digits, value);
+    return write(buf);
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    if (on_serial_write) {
+        on_serial_write(buffer, size);
+    }
+    return size;
+}
+
+// SerialTwoWire
+
+uint8_t SerialTwoWire::endTransmission(uint8_t)
+{
+    if (on_i2c_master_transmit) {
+        on_i2c_master_transmit(_transmitAddress, _tx.data(), _tx.size());
+    }
+    _tx.clear();
+    return 0;
+}
+
+void SerialTwoWire::_processQueue()
+{
+    while (!_queue.empty()) {
+        auto data = std::move(_queue.front());
+        _queue.pop_front();
+        if (data.empty()) {
+            _tx.clear();
+            if (_onRequest) {
+                _onRequest();
+            }
+            if (on_i2c_slave_transmit) {
+                on_i2c_slave_transmit(_tx.data(), _tx.size());
+            }
+            _tx.clear();
+        }
+        else {
+            _rx = std::move(data);
+            _rxPos = 0;
+            if (_onReceive) {
+                _onReceive(_rx.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,256 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// minimal Arduino API for the native environment
+// time is taken from the simulated CPU clock, see sim_hal.h
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/pgmspace.h>
+
+#ifndef F_CPU
+#    define F_CPU 8000000UL
+#endif
+
+using std::nullptr_t;
+
+#define HIGH                                0x1
+#define LOW                                 0x0
+
+#define INPUT                               0x0
+#define OUTPUT                              0x1
+#define INPUT_PULLUP                        0x2
+
+#define CHANGE                              1
+#define FALLING                             2
+#define RISING                              3
+
+#define DEC                                 10
+#define HEX                                 16
+#define OCT                                 8
+#define BIN                                 2
+
+#define NOT_A_PIN                           0
+#define NOT_A_PORT                          0
+#define NOT_AN_INTERRUPT                    -1
+
+#define PB                                  2
+#define PC                                  3
+#define PD                                  4
+
+// ATmega328P pin mapping, pin 0-7 PORTD, 8-13 PORTB, 14-19 PORTC (A0-A5), A6 and A7 are analog inputs only
+#define PIN_A0                              (14)
+#define PIN_A1                              (15)
+#define PIN_A2                              (16)
+#define PIN_A3                              (17)
+#define PIN_A4                              (18)
+#define PIN_A5                              (19)
+#define PIN_A6                              (20)
+#define PIN_A7                              (21)
+
+static constexpr uint8_t A0 = PIN_A0;
+static constexpr uint8_t A1 = PIN_A1;
+static constexpr uint8_t A2 = PIN_A2;
+static constexpr uint8_t A3 = PIN_A3;
+static constexpr uint8_t A4 = PIN_A4;
+static constexpr uint8_t A5 = PIN_A5;
+static constexpr uint8_t A6 = PIN_A6;
+static constexpr uint8_t A7 = PIN_A7;
+
+static constexpr uint8_t SDA = PIN_A4;
+static constexpr uint8_t SCL = PIN_A5;
+
+#define NUM_DIGITAL_PINS                    20
+#define NUM_ANALOG_INPUTS                   8
+#define analogInputToDigitalPin(p)          ((p < 6) ? (p) + 14 : -1)
+
+// must be usable in #if
+#define digitalPinToInterrupt(p)            ((p) == 2 ? 0 : ((p) == 3 ? 1 : NOT_AN_INTERRUPT))
+
+#define digitalPinToPort(p)                 ((p) < 8 ? PD : ((p) < 14 ? PB : ((p) < 20 ? PC : NOT_A_PORT)))
+#define digitalPinToBitMask(p)              _BV((p) < 8 ? (p) : ((p) < 14 ? (p) - 8 : ((p) - 14)))
+#define portOutputRegister(P)               ((P) == PB ? &PORTB : ((P) == PC ? &PORTC : ((P) == PD ? &PORTD : nullptr)))
+#define portInputRegister(P)                ((P) == PB ? &PINB : ((P) == PC ? &PINC : ((P) == PD ? &PIND : nullptr)))
+#define portModeRegister(P)                 ((P) == PB ? &DDRB : ((P) == PC ? &DDRC : ((P) == PD ? &DDRD : nullptr)))
+
+#define clockCyclesPerMicrosecond()         (F_CPU / 1000000L)
+#define clockCyclesToMicroseconds(a)        ((a) / clockCyclesPerMicrosecond())
+#define microsecondsToClockCycles(a)        ((a) * clockCyclesPerMicrosecond())
+
+#define interrupts()                        sei()
+#define noInterrupts()                      cli()
+
+#define lowByte(w)                          ((uint8_t)((w) & 0xff))
+#define highByte(w)                         ((uint8_t)((w) >> 8))
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef unsigned int word;
+
+uint32_t millis();
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(unsigned int us);
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void analogReference(uint8_t mode);
+
+void attachInterrupt(uint8_t interruptNum, void (*userFunc)(void), int mode);
+void detachInterrupt(uint8_t interruptNum);
+
+void yield();
+void optimistic_yield(uint32_t);
+
+void setup();
+void loop();
+void serialEvent();
+
+class __FlashStringHelper;
+
+#define F(string_literal)                   (reinterpret_cast<const __FlashStringHelper *>(PSTR(string_literal)))
+
+class String {
+public:
+    String() {}
+    String(const char *str) : _str(str ? str : "") {}
+    String(const __FlashStringHelper *str) : String(reinterpret_cast<const char *>(str)) {}
+
+    String &operator=(const char *str) {
+        _str = str ? str : "";
+        return *this;
+    }
+    String &operator+=(const char *str) {
+        _str += str;
+        return *this;
+    }
+    String &operator+=(char ch) {
+        _str += ch;
+        return *this;
+    }
+    String &operator+=(const String &str) {
+        _str += str._str;
+        return *this;
+    }
+
+    void remove(unsigned int index, unsigned int count = ~0U) {
+        if (index < _str.length()) {
+            _str.erase(index, count);
+        }
+    }
+
+    unsigned int length() const {
+        return _str.length();
+    }
+    const char *c_str() const {
+        return _str.c_str();
+    }
+    char charAt(unsigned int index) const {
+        return index < _str.length() ? _str[index] : 0;
+    }
+    bool equals(const char *str) const {
+        return _str == str;
+    }
+    bool startsWith(const char *str) const {
+        return _str.compare(0, strlen(str), str) == 0;
+    }
+
+private:
+    std::string _str;
+};
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t *buffer, size_t size);
+    size_t write(const char *str) {
+        return str ? write(reinterpret_cast<const uint8_t *>(str), strlen(str)) : 0;
+    }
+    size_t write(const char *buffer, size_t size) {
+        return write(reinterpret_cast<const uint8_t *>(buffer), size);
+    }
+    virtual void flush() {}
+
+    size_t print(const __FlashStringHelper *str) {
+        return write(reinterpret_cast<const char *>(str));
+    }
+    size_t print(const String &str) {
+        return write(str.c_str());
+    }
+    size_t print(const char str[]) {
+        return write(str);
+    }
+    size_t print(char ch) {
+        return write(static_cast<uint8_t>(ch));
+    }
+    size_t print(unsigned char value, int base = DEC) {
+        return print(static_cast<unsigned long>(value), base);
+    }
+    size_t print(int value, int base = DEC) {
+        return print(static_cast<long>(value), base);
+    }
+    size_t print(unsigned int value, int base = DEC) {
+        return print(static_cast<unsigned long>(value), base);
+    }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int digits = 2);
+
+    template<typename _Ta>
+    size_t println(_Ta value) {
+        return print(value) + println();
+    }
+    template<typename _Ta>
+    size_t println(_Ta value, int format) {
+        return print(value, format) + println();
+    }
+    size_t println() {
+        return write("\r\n");
+    }
+
+private:
+    friend void __debug_printf(const char *format, ...);
+    typedef int (* vsnprint_t)(char *, size_t, const char *, va_list ap);
+    size_t __printf(vsnprint_t func, const char *format, va_list arg);
+
+public:
+    size_t printf(const char *format, ...);
+    size_t printf_P(PGM_P format, ...);
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    size_t readBytes(uint8_t *buffer, size_t length) {
+        size_t count = 0;
+        int ch;
+        while (count < length && (ch = read()) != -1) {
+            *buffer++ = static_cast<uint8_t>(ch);
+            count++;
+        }
+        return count;
+    }
+    size_t readBytes(char *buffer, size_t length) {
+        return readBytes(reinterpret_cast<uint8_t *>(buffer), length);
+    }
+};
+
+#include "HardwareSerial.h"
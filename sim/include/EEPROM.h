@@ -0,0 +1,57 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class EEPROMClass {
+public:
+    EEPROMClass() {
+        memset(_data, 0xff, sizeof(_data));
+    }
+
+    uint8_t read(int idx) const {
+        return _data[idx];
+    }
+    void write(int idx, uint8_t value) {
+        _data[idx] = value;
+        _writes++;
+    }
+    void update(int idx, uint8_t value) {
+        if (_data[idx] != value) {
+            write(idx, value);
+        }
+    }
+
+    template<typename _Ta>
+    _Ta &get(int idx, _Ta &value) {
+        memcpy(reinterpret_cast<void *>(&value), &_data[idx], sizeof(value));
+        return value;
+    }
+
+    template<typename _Ta>
+    const _Ta &put(int idx, const _Ta &value) {
+        auto ptr = reinterpret_cast<const uint8_t *>(&value);
+        for (size_t i = 0; i < sizeof(value); i++) {
+            update(idx + i, ptr[i]);
+        }
+        return value;
+    }
+
+    uint16_t length() const {
+        return sizeof(_data);
+    }
+
+    // number of bytes written
+    uint32_t _getWrites() const {
+        return _writes;
+    }
+
+private:
+    uint8_t _data[E2END + 1];
+    uint32_t _writes{0};
+};
+
+extern EEPROMClass EEPROM;
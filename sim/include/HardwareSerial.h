@@ -0,0 +1,64 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <deque>
+
+#ifndef SERIAL_RX_BUFFER_SIZE
+#    define SERIAL_RX_BUFFER_SIZE 64
+#endif
+
+// the output is written to the file set by the simulator, the input is fed by the simulator
+class HardwareSerial : public Stream {
+public:
+    void begin(unsigned long baud) {
+        _baud = baud;
+    }
+    void end() {
+        _baud = 0;
+    }
+
+    virtual int available() override {
+        return _rx.size();
+    }
+    virtual int read() override {
+        if (_rx.empty()) {
+            return -1;
+        }
+        auto ch = _rx.front();
+        _rx.pop_front();
+        return ch;
+    }
+    virtual int peek() override {
+        return _rx.empty() ? -1 : _rx.front();
+    }
+
+    using Print::write;
+    virtual size_t write(uint8_t ch) override {
+        return write(&ch, 1);
+    }
+    virtual size_t write(const uint8_t *buffer, size_t size) override;
+
+    operator bool() const {
+        return true;
+    }
+
+    // feed data into the receive buffer, data that does not fit is discarded
+    size_t _receive(const uint8_t *buffer, size_t size) {
+        size_t count = 0;
+        while (size-- && _rx.size() < SERIAL_RX_BUFFER_SIZE) {
+            _rx.push_back(*buffer++);
+            count++;
+        }
+        return count;
+    }
+
+private:
+    unsigned long _baud{0};
+    std::deque<uint8_t> _rx;
+};
+
+extern HardwareSerial Serial;
@@ -0,0 +1,82 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// drop-in replacement for the I2C over UART bridge
+// the simulator queues transactions from the master, which are executed when serialEvent() is called
+
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include <deque>
+
+class SerialTwoWire : public Stream {
+public:
+    using onReceiveCallback = void (*)(int);
+    using onRequestCallback = void (*)();
+
+    void begin() {}
+    void begin(uint8_t address) {
+        _address = address;
+    }
+    void end() {}
+
+    void onReceive(onReceiveCallback callback) {
+        _onReceive = callback;
+    }
+    void onRequest(onRequestCallback callback) {
+        _onRequest = callback;
+    }
+
+    void beginTransmission(uint8_t address) {
+        _transmitAddress = address;
+        _tx.clear();
+    }
+    uint8_t endTransmission(uint8_t sendStop = true);
+
+    using Print::write;
+    virtual size_t write(uint8_t data) override {
+        _tx.push_back(data);
+        return 1;
+    }
+    virtual size_t write(const uint8_t *buffer, size_t size) override {
+        _tx.insert(_tx.end(), buffer, buffer + size);
+        return size;
+    }
+
+    virtual int available() override {
+        return _rx.size() - _rxPos;
+    }
+    virtual int read() override {
+        return _rxPos < _rx.size() ? _rx[_rxPos++] : -1;
+    }
+    virtual int peek() override {
+        return _rxPos < _rx.size() ? _rx[_rxPos] : -1;
+    }
+
+    // queue a write transaction from the master
+    void _queueTransmission(const uint8_t *buffer, size_t size) {
+        _queue.emplace_back(buffer, buffer + size);
+    }
+
+    // queue a read request from the master
+    void _queueRequest() {
+        _queue.emplace_back();
+    }
+
+    // execute queued transactions
+    void _processQueue();
+
+private:
+    uint8_t _address{0};
+    uint8_t _transmitAddress{0};
+    onReceiveCallback _onReceive{nullptr};
+    onRequestCallback _onRequest{nullptr};
+    std::vector<uint8_t> _rx;
+    size_t _rxPos{0};
+    std::vector<uint8_t> _tx;
+    std::deque<std::vector<uint8_t>> _queue;
+};
+
+extern SerialTwoWire Wire;
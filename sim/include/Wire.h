@@ -0,0 +1,9 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include "SerialTwoWire.h"
+
+using TwoWire = SerialTwoWire;
@@ -0,0 +1,28 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#define GET_LOW_FUSE_BITS                   (0x0000)
+#define GET_LOCK_BITS                       (0x0001)
+#define GET_EXTENDED_FUSE_BITS              (0x0002)
+#define GET_HIGH_FUSE_BITS                  (0x0003)
+
+namespace Simulator {
+
+    // ATmega328PB signature and the fuses of the 8MHz board
+    inline uint8_t boot_signature_byte_get(uint16_t addr) {
+        return addr == 0 ? 0x1e : (addr == 2 ? 0x95 : (addr == 4 ? 0x16 : 0xff));
+    }
+
+    inline uint8_t boot_lock_fuse_bits_get(uint16_t addr) {
+        return addr == GET_LOW_FUSE_BITS ? 0xff : (addr == GET_HIGH_FUSE_BITS ? 0xc2 : (addr == GET_EXTENDED_FUSE_BITS ? 0xf7 : 0x0f));
+    }
+
+}
+
+using Simulator::boot_signature_byte_get;
+using Simulator::boot_lock_fuse_bits_get;
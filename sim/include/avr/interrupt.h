@@ -0,0 +1,14 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include "sim_hal.h"
+
+// the simulator calls the vectors by name, unused vectors have a weak default handler
+#define ISR(vector, ...)                    extern "C" void vector(void); extern "C" void vector(void)
+
+#define cli()                               Simulator::cpu.disable_interrupts()
+#define sei()                               Simulator::cpu.enable_interrupts()
+#define reti()                              return
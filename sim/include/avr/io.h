@@ -0,0 +1,141 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// ATmega328P registers used by the firmware
+
+#pragma once
+
+#include <stdint.h>
+#include "sim_hal.h"
+
+#define _BV(bit)                            (1 << (bit))
+#define bit_is_set(sfr, bit)                ((sfr) & _BV(bit))
+#define bit_is_clear(sfr, bit)              (!((sfr) & _BV(bit)))
+#define loop_until_bit_is_set(sfr, bit)     do { } while (bit_is_clear(sfr, bit))
+#define loop_until_bit_is_clear(sfr, bit)   do { } while (bit_is_set(sfr, bit))
+
+#define E2END                               0x3ff
+
+// ports
+
+extern volatile uint8_t PINB;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t PORTB;
+extern volatile uint8_t PINC;
+extern volatile uint8_t DDRC;
+extern volatile uint8_t PORTC;
+extern volatile uint8_t PIND;
+extern volatile uint8_t DDRD;
+extern volatile uint8_t PORTD;
+
+// timer 1
+
+extern uint8_t TCCR1A;
+extern Simulator::ClockSelectRegister TCCR1B;
+extern Simulator::CounterRegister TCNT1;
+extern volatile uint16_t OCR1A;
+extern volatile uint16_t OCR1B;
+extern volatile uint16_t ICR1;
+extern volatile uint8_t TIMSK1;
+extern Simulator::FlagRegister TIFR1;
+
+#define TOV1                                0
+#define OCF1A                               1
+#define OCF1B                               2
+#define ICF1                                5
+
+#define TOIE1                               0
+#define OCIE1A                              1
+#define OCIE1B                              2
+#define ICIE1                               5
+
+#define CS10                                0
+#define CS11                                1
+#define CS12                                2
+#define ICES1                               6
+#define ICNC1                               7
+
+// timer 2
+
+extern uint8_t TCCR2A;
+extern Simulator::ClockSelectRegister TCCR2B;
+extern Simulator::CounterRegister TCNT2;
+extern volatile uint8_t TIMSK2;
+extern Simulator::FlagRegister TIFR2;
+
+#define TOV2                                0
+#define OCF2A                               1
+#define OCF2B                               2
+
+#define TOIE2                               0
+#define OCIE2A                              1
+#define OCIE2B                              2
+
+#define CS20                                0
+#define CS21                                1
+#define CS22                                2
+
+// external interrupts
+
+extern volatile uint8_t EICRA;
+extern volatile uint8_t EIMSK;
+extern volatile uint8_t EIFR;
+
+// ADC
+
+extern volatile uint8_t ADMUX;
+extern Simulator::AdcControlRegister ADCSRA;
+extern volatile uint8_t ADCSRB;
+
+#define ADC                                 (Simulator::adc_read())
+
+#define ADPS0                               0
+#define ADPS1                               1
+#define ADPS2                               2
+#define ADIE                                3
+#define ADIF                                4
+#define ADATE                               5
+#define ADSC                                6
+#define ADEN                                7
+
+#define ADTS0                               0
+#define ADTS1                               1
+#define ADTS2                               2
+
+#define MUX0                                0
+#define MUX1                                1
+#define MUX2                                2
+#define MUX3                                3
+#define ADLAR                               5
+#define REFS0                               6
+#define REFS1                               7
+
+// TWI
+
+extern volatile uint8_t TWBR;
+extern volatile uint8_t TWSR;
+extern volatile uint8_t TWAR;
+extern volatile uint8_t TWDR;
+extern volatile uint8_t TWAMR;
+extern Simulator::TwiControlRegister TWCR;
+
+#define TWIE                                0
+#define TWEN                                2
+#define TWWC                                3
+#define TWSTO                               4
+#define TWSTA                               5
+#define TWEA                                6
+#define TWINT                               7
+
+#define TWPS0                               0
+#define TWPS1                               1
+
+#define TWGCE                               0
+
+// self programming
+
+extern volatile uint8_t SPMCSR;
+
+#define SPMEN                               0
+#define SIGRD                               5
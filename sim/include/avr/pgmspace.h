@@ -0,0 +1,28 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// the native environment has a single address space
+
+#pragma once
+
+#include <stdio.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P                               const char *
+#define PSTR(str)                           (str)
+
+#define pgm_read_byte(addr)                 (*reinterpret_cast<const uint8_t *>(addr))
+#define pgm_read_word(addr)                 (*reinterpret_cast<const uint16_t *>(addr))
+#define pgm_read_dword(addr)                (*reinterpret_cast<const uint32_t *>(addr))
+#define pgm_read_float(addr)                (*reinterpret_cast<const float *>(addr))
+#define pgm_read_ptr(addr)                  (*reinterpret_cast<void * const *>(addr))
+
+#define strlen_P                            strlen
+#define strcmp_P                            strcmp
+#define strncmp_P                           strncmp
+#define strcpy_P                            strcpy
+#define memcpy_P                            memcpy
+#define snprintf_P                          snprintf
+#define vsnprintf_P                         vsnprintf
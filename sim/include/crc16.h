@@ -0,0 +1,33 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// same polynomial as _crc16_update() from avr-libc
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+inline uint16_t crc16_update(uint16_t crc, const uint8_t data)
+{
+    crc ^= data;
+    for (uint8_t i = 0; i < 8; ++i) {
+        crc = (crc & 1) ? ((crc >> 1) ^ 0xa001) : (crc >> 1);
+    }
+    return crc;
+}
+
+inline uint16_t crc16_update(uint16_t crc, const void *data, size_t len)
+{
+    auto ptr = reinterpret_cast<const uint8_t *>(data);
+    while (len--) {
+        crc = crc16_update(crc, *ptr++);
+    }
+    return crc;
+}
+
+inline uint16_t crc16_update(const void *data, size_t len)
+{
+    return crc16_update(~0, data, len);
+}
@@ -0,0 +1,220 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// hardware abstraction layer for the native environment
+//
+// the firmware runs on a simulated clock. the registers of timer 1 and 2 are derived from the cycle counter,
+// interrupt flags are latched at the cycle they occur and the vectors are called in the same order as on the ATmega328P.
+// the code itself takes no time, each interrupt adds a fixed number of cycles for the response time and prologue
+// before the handler is called. calls to millis(), micros() and yield() from the main loop advance the clock
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace Simulator {
+
+    using cycles_t = uint64_t;
+
+    static constexpr cycles_t kNever = ~static_cast<cycles_t>(0);
+
+    // cycles since reset
+    extern cycles_t cycles;
+
+    // interrupt vectors ordered by priority
+    enum class Vector : uint8_t {
+        kInt0,
+        kInt1,
+        kTimer2Overflow,
+        kTimer1Capture,
+        kTimer1CompareA,
+        kTimer1CompareB,
+        kTimer1Overflow,
+        kTwi,
+        kSize
+    };
+
+    struct Cpu {
+        bool interrupts;
+        uint8_t isr_level;
+
+        void disable_interrupts() {
+            interrupts = false;
+        }
+        void enable_interrupts() {
+            interrupts = true;
+        }
+        bool in_isr() const {
+            return isr_level != 0;
+        }
+    };
+
+    extern Cpu cpu;
+
+    struct Timer {
+        uint32_t top;
+        uint16_t prescaler;
+        cycles_t start;
+        uint32_t base;
+
+        uint32_t count() const;
+        void set_count(uint32_t value);
+        void set_prescaler(uint16_t value);
+        // cycle when the counter changes to value, kNever if the timer is stopped
+        cycles_t next(uint32_t value) const;
+    };
+
+    extern Timer timer1;
+    extern Timer timer2;
+
+    // TCNTx
+    struct CounterRegister {
+        Timer &timer;
+
+        // reading the counter takes 2 clock cycles, which advances the time in busy loops
+        operator uint16_t() const;
+        CounterRegister &operator=(uint16_t value) {
+            timer.set_count(value);
+            return *this;
+        }
+    };
+
+    // TCCRxB, CSx0-CSx2 select the prescaler
+    struct ClockSelectRegister {
+        Timer &timer;
+        const uint16_t *prescalers;
+        uint8_t value;
+
+        operator uint8_t() const {
+            return value;
+        }
+        ClockSelectRegister &operator=(uint8_t newValue) {
+            value = newValue;
+            timer.set_prescaler(prescalers[value & 0x07]);
+            return *this;
+        }
+        ClockSelectRegister &operator|=(uint8_t bits) {
+            return operator=(value | bits);
+        }
+        ClockSelectRegister &operator&=(uint8_t bits) {
+            return operator=(value & bits);
+        }
+    };
+
+    // TIFRx, writing a one clears the flag. the registers are in the I/O space and |= compiles to sbi which clears a single flag
+    struct FlagRegister {
+        uint8_t value;
+
+        operator uint8_t() const {
+            return value;
+        }
+        FlagRegister &operator=(uint8_t bits) {
+            value &= ~bits;
+            return *this;
+        }
+        FlagRegister &operator|=(uint8_t bits) {
+            value &= ~bits;
+            return *this;
+        }
+    };
+
+    // ADCSRA, the conversion completes immediately
+    struct AdcControlRegister {
+        uint8_t value;
+
+        operator uint8_t() const {
+            return value & ~(1 << 6);
+        }
+        AdcControlRegister &operator=(uint8_t newValue) {
+            value = newValue;
+            return *this;
+        }
+        AdcControlRegister &operator|=(uint8_t bits) {
+            value |= bits;
+            return *this;
+        }
+        AdcControlRegister &operator&=(uint8_t bits) {
+            value &= bits;
+            return *this;
+        }
+    };
+
+    // TWCR, writing a one to TWINT clears the flag and starts the next operation of the TWI. reading it while
+    // the TWI is busy advances the clock to let the firmware poll TWINT
+    struct TwiControlRegister {
+        uint8_t value;
+
+        operator uint8_t() const;
+        TwiControlRegister &operator=(uint8_t newValue);
+        TwiControlRegister &operator|=(uint8_t bits) {
+            return operator=(*this | bits);
+        }
+        TwiControlRegister &operator&=(uint8_t bits) {
+            return operator=(*this & bits);
+        }
+    };
+
+    // queue a write transaction from the I2C master. the bus runs at 100kHz
+    void twi_queue_write(uint8_t address, const uint8_t *buffer, size_t size);
+    // queue a read transaction, the data is passed to on_i2c_slave_transmit
+    void twi_queue_read(uint8_t address, uint8_t length);
+    // do not acknowledge the address of the next COUNT transactions from the firmware
+    void twi_nack_master(unsigned count);
+
+    // ADC values for each multiplexer channel
+    extern uint16_t adc_values[16];
+
+    uint16_t adc_read();
+
+    // signal source for input pins
+    class Source {
+    public:
+        virtual ~Source() {}
+        // cycle of the next event or kNever
+        virtual cycles_t next_event() = 0;
+        // called when the clock reaches next_event()
+        virtual void event() = 0;
+    };
+
+    void set_source(Source *source);
+
+    // change the level of an input pin and latch the external interrupt flag if the edge matches the mode
+    void set_pin(uint8_t pin, bool level);
+
+    // run the simulation from the main loop until the clock reaches the cycle
+    void advance(cycles_t until);
+
+    inline void run_for(cycles_t count) {
+        advance(cycles + count);
+    }
+
+    // compare the output registers with the last state and report changes
+    void check_ports();
+
+    // cycles added before the interrupt handler is called
+    extern uint16_t isr_overhead_cycles;
+    // cycles added for each call to millis(), micros() and yield() from the main loop
+    extern uint16_t main_call_cycles;
+
+    struct VectorStats {
+        uint64_t count;
+        uint64_t host_nanos;
+        uint64_t host_nanos_max;
+    };
+
+    extern VectorStats vector_stats[static_cast<uint8_t>(Vector::kSize)];
+
+    const char *get_vector_name(Vector vector);
+
+    // PB, PC or PD
+    extern void (*on_port_change)(uint8_t port, uint8_t previous, uint8_t current);
+    // output of the serial port
+    extern void (*on_serial_write)(const uint8_t *buffer, size_t size);
+    // the slave sent data to the master address
+    extern void (*on_i2c_master_transmit)(uint8_t address, const uint8_t *buffer, size_t size);
+    // response for a request from the master
+    extern void (*on_i2c_slave_transmit)(const uint8_t *buffer, size_t size);
+
+}
@@ -0,0 +1,37 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <avr/interrupt.h>
+
+namespace Simulator {
+
+    // the destructor restores the interrupt flag, even if the block is left with return or break
+    template<bool _ForceOn>
+    class AtomicBlock {
+    public:
+        AtomicBlock() : _interrupts(cpu.interrupts), _once(true) {
+            cpu.disable_interrupts();
+        }
+        ~AtomicBlock() {
+            cpu.interrupts = _ForceOn ? true : _interrupts;
+        }
+        bool once() {
+            auto tmp = _once;
+            _once = false;
+            return tmp;
+        }
+
+    private:
+        bool _interrupts;
+        bool _once;
+    };
+
+}
+
+#define ATOMIC_RESTORESTATE                 false
+#define ATOMIC_FORCEON                      true
+
+#define ATOMIC_BLOCK(type)                  for (Simulator::AtomicBlock<type> __atomic_block; __atomic_block.once(); )
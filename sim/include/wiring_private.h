@@ -0,0 +1,10 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#define cbi(sfr, bit)                       ((sfr) &= ~_BV(bit))
+#define sbi(sfr, bit)                       ((sfr) |= _BV(bit))
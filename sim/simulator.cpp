@@ -0,0 +1,795 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// runs the firmware against a simulated zero crossing signal and records the gate edges of each channel
+//
+// pio run -e native
+// .pio/build/native/program --halfwaves=100000 --level=0:4000 --fade=1:0:8192:2.5:3 --jitter=20
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <getopt.h>
+#include <inttypes.h>
+#include <chrono>
+#include <deque>
+#include <random>
+#include <crc16.h>
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#endif
+#include "dimmer.h"
+#include "config.h"
+#include "measure_frequency.h"
+#include "isr_stats.h"
+
+using namespace Simulator;
+
+#if DIMMER_ZC_INTERRUPT_MODE == FALLING
+    static constexpr bool kZCActiveLevel = LOW;
+#else
+    static constexpr bool kZCActiveLevel = HIGH;
+#endif
+
+static constexpr double kCyclesPerMicro = F_CPU / 1000000.0;
+
+// set after the dimmer has been started
+static bool recording;
+
+// zero crossing signal with jitter, missing pulses, spikes and a changing frequency
+class MainsSource : public Source {
+public:
+    static constexpr double kMinSpikeMicros = 0.5;
+    static constexpr double kMaxSpikeMicros = 5;
+
+    MainsSource(double frequency, double jitterMicros, double pulseWidthMicros, double missing, double noise, double drift, uint32_t seed) :
+        _frequency(frequency),
+        _drift(drift),
+        _halfwave(F_CPU / (frequency * 2.0)),
+        _jitter(jitterMicros * kCyclesPerMicro),
+        _pulseWidth(pulseWidthMicros * kCyclesPerMicro),
+        _missing(missing),
+        _noise(noise),
+        _zeroCrossing(_halfwave),
+        _lastZeroCrossing(0),
+        _count(0),
+        _random(seed),
+        _active(false),
+        _spike(kNever),
+        _spikeEnd(kNever)
+    {
+        _next = _edge();
+    }
+
+    virtual cycles_t next_event() override {
+        return std::min(_next, _spike);
+    }
+
+    virtual void event() override {
+        if (_spike == cycles) {
+            if (_spikeEnd == kNever) {
+                _spikeEnd = cycles + std::uniform_real_distribution<double>(kMinSpikeMicros, kMaxSpikeMicros)(_random) * kCyclesPerMicro;
+                _spike = _spikeEnd;
+                set_pin(ZC_SIGNAL_PIN, kZCActiveLevel);
+            }
+            else {
+                _spike = kNever;
+                _spikeEnd = kNever;
+                set_pin(ZC_SIGNAL_PIN, !kZCActiveLevel);
+            }
+            return;
+        }
+        if (_active) {
+            _active = false;
+            set_pin(ZC_SIGNAL_PIN, !kZCActiveLevel);
+            if (_drift && recording) {
+                _frequency += _drift / (_frequency * 2.0);
+                _halfwave = F_CPU / (_frequency * 2.0);
+            }
+            _zeroCrossing += _halfwave;
+            _next = _edge();
+            // spike between the pulses
+            if (recording && std::uniform_real_distribution<double>(0, 1)(_random) < _noise) {
+                auto margin = 10 * kCyclesPerMicro;
+                _spike = std::uniform_real_distribution<double>(cycles + margin, _next - margin - kMaxSpikeMicros * kCyclesPerMicro)(_random);
+            }
+            return;
+        }
+        _lastZeroCrossing = static_cast<cycles_t>(_zeroCrossing);
+        _count++;
+        _active = true;
+        if (std::uniform_real_distribution<double>(0, 1)(_random) >= _missing) {
+            set_pin(ZC_SIGNAL_PIN, kZCActiveLevel);
+        }
+        _next = cycles + _pulseWidth;
+    }
+
+    cycles_t last_zero_crossing() const {
+        return _lastZeroCrossing;
+    }
+
+    uint64_t count() const {
+        return _count;
+    }
+
+    double frequency() const {
+        return _frequency;
+    }
+
+private:
+    cycles_t _edge() {
+        double offset = _jitter ? std::uniform_real_distribution<double>(-_jitter, _jitter)(_random) : 0;
+        return std::max<cycles_t>(cycles + 1, _zeroCrossing + offset);
+    }
+
+    double _frequency;
+    double _drift;
+    double _halfwave;
+    double _jitter;
+    cycles_t _pulseWidth;
+    double _missing;
+    double _noise;
+    double _zeroCrossing;
+    cycles_t _lastZeroCrossing;
+    uint64_t _count;
+    std::mt19937 _random;
+    bool _active;
+    cycles_t _next;
+    cycles_t _spike;
+    cycles_t _spikeEnd;
+};
+
+struct ChannelStats {
+    bool on;
+    cycles_t on_time;
+    uint64_t pulses;
+    cycles_t width_min;
+    cycles_t width_max;
+    uint64_t width_sum;
+    cycles_t delay_min;
+    cycles_t delay_max;
+    uint64_t delay_sum;
+    uint64_t delay_count;
+    int64_t error_min;
+    int64_t error_max;
+};
+
+static MainsSource *mains;
+static ChannelStats channel_stats[Dimmer::Channel::size()];
+static uint64_t event_count[256];
+static FILE *csv;
+static bool echo_serial;
+
+static void port_change(uint8_t port, uint8_t previous, uint8_t current)
+{
+    if (!recording) {
+        return;
+    }
+    for(Dimmer::Channel::type i = 0; i < Dimmer::Channel::size(); i++) {
+        auto pin = Dimmer::Channel::pins[i];
+        auto mask = digitalPinToBitMask(pin);
+        if (digitalPinToPort(pin) != port || ((previous ^ current) & mask) == 0) {
+            continue;
+        }
+        auto &stats = channel_stats[i];
+        bool on = ((current & mask) != 0) == DIMMER_MOSFET_ON_STATE;
+        auto delay = cycles - mains->last_zero_crossing();
+        if (csv) {
+            fprintf(csv, "%" PRIu64 ",%d,%u,%.3f\n", cycles, i, on, delay / kCyclesPerMicro);
+        }
+        if (on) {
+            stats.on = true;
+            stats.on_time = cycles;
+            stats.delay_min = std::min(stats.delay_min, delay);
+            stats.delay_max = std::max(stats.delay_max, delay);
+            stats.delay_sum += delay;
+            stats.delay_count++;
+        }
+        else if (stats.on) {
+            stats.on = false;
+            auto width = cycles - stats.on_time;
+            stats.pulses++;
+            stats.width_min = std::min(stats.width_min, width);
+            stats.width_max = std::max(stats.width_max, width);
+            stats.width_sum += width;
+            if (!dimmer._config.bits.leading_edge) {
+                // compare with the ticks scheduled for this half wave
+                for(auto slot = dimmer.halfwave_slots.slots; slot->ticks; slot++) {
+                    if (slot->mask[Dimmer::Ports::index[i]] & dimmer_pins_mask[i]) {
+                        int64_t error = width - static_cast<cycles_t>(slot->ticks) * Dimmer::Timer<1>::prescaler;
+                        stats.error_min = std::min(stats.error_min, error);
+                        stats.error_max = std::max(stats.error_max, error);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+static void i2c_master_transmit(uint8_t address, const uint8_t *buffer, size_t size);
+static void i2c_slave_transmit(const uint8_t *buffer, size_t size);
+
+#if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+
+static constexpr cycles_t kSerialByteCycles = F_CPU * 10 / DEFAULT_BAUD_RATE;
+
+static struct {
+    // frames sent to the dimmer with DEFAULT_BAUD_RATE
+    std::deque<uint8_t> input;
+    cycles_t next;
+    cycles_t start;
+    cycles_t last;
+    size_t bytes;
+    // size of the same transactions as +I2CT= and +I2CR= lines
+    size_t text_bytes;
+    // frame received from the dimmer
+    std::vector<uint8_t> output;
+} serial_frames;
+
+static void frame_send(uint8_t type, uint8_t address, const uint8_t *data, size_t size)
+{
+    std::vector<uint8_t> frame = { DIMMER_FRAME_START, static_cast<uint8_t>(size + 1), type, address };
+    frame.insert(frame.end(), data, data + size);
+    uint16_t crc = crc16_update(&frame[1], frame.size() - 1);
+    frame.push_back(crc & 0xff);
+    frame.push_back(crc >> 8);
+    if (serial_frames.input.empty()) {
+        serial_frames.next = cycles;
+        if (!serial_frames.bytes) {
+            serial_frames.start = cycles;
+        }
+    }
+    serial_frames.input.insert(serial_frames.input.end(), frame.begin(), frame.end());
+    serial_frames.bytes += frame.size();
+    serial_frames.text_bytes += 6 + (size + 1) * 2 + 1;
+}
+
+static void frame_feed()
+{
+    while (!serial_frames.input.empty() && cycles >= serial_frames.next) {
+        if (!Serial._receive(&serial_frames.input.front(), 1)) {
+            break;
+        }
+        serial_frames.input.pop_front();
+        serial_frames.next += kSerialByteCycles;
+        serial_frames.last = cycles;
+    }
+}
+
+static void frame_receive(uint8_t ch)
+{
+    auto &frame = serial_frames.output;
+    if (frame.empty() && ch != DIMMER_FRAME_START) {
+        if (echo_serial) {
+            putchar(ch);
+        }
+        return;
+    }
+    frame.push_back(ch);
+    if (frame.size() < 2) {
+        return;
+    }
+    size_t length = frame[1] + SerialFrameTwoWire::kFrameOverhead;
+    if (frame[1] == 0) {
+        frame.clear();
+        return;
+    }
+    if (frame.size() < length) {
+        return;
+    }
+    uint16_t crc = crc16_update(&frame[1], frame[1] + 2);
+    if (crc != (frame[length - 2] | (frame[length - 1] << 8))) {
+        printf("frame with invalid CRC\n");
+    }
+    else if (frame[2] == DIMMER_FRAME_TYPE_TRANSMIT) {
+        i2c_master_transmit(frame[3], &frame[4], frame[1] - 1);
+    }
+    else if (frame[2] == DIMMER_FRAME_TYPE_RESPONSE) {
+        i2c_slave_transmit(&frame[4], frame[1] - 1);
+    }
+    frame.clear();
+}
+
+#endif
+
+static void serial_write(const uint8_t *buffer, size_t size)
+{
+    #if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+        while (size--) {
+            frame_receive(*buffer++);
+        }
+    #else
+        if (echo_serial) {
+            fwrite(buffer, 1, size, stdout);
+        }
+    #endif
+}
+
+// transactions from the master
+static void queue_write(uint8_t address, const uint8_t *buffer, size_t size)
+{
+    #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+        twi_queue_write(address, buffer, size);
+    #elif SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+        frame_send(DIMMER_FRAME_TYPE_TRANSMIT, address, buffer, size);
+    #else
+        Wire._queueTransmission(buffer, size);
+    #endif
+}
+
+static void queue_read(uint8_t address, uint8_t length)
+{
+    #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+        twi_queue_read(address, length);
+    #elif SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+        frame_send(DIMMER_FRAME_TYPE_REQUEST, address, &length, 1);
+    #else
+        Wire._queueRequest();
+    #endif
+}
+
+static void i2c_master_transmit(uint8_t address, const uint8_t *buffer, size_t size)
+{
+    if (size) {
+        event_count[buffer[0]]++;
+    }
+    if (size && buffer[0] == DIMMER_EVENT_COMPOUND) {
+        // count the events inside the compound event as well
+        for(size_t pos = 1; pos < size && buffer[pos]; pos += buffer[pos] + 1) {
+            event_count[buffer[pos + 1]]++;
+        }
+    }
+    if (echo_serial) {
+        printf("+I2CT=%02x", address);
+        for(size_t i = 0; i < size; i++) {
+            printf("%02x", buffer[i]);
+        }
+        printf("\n");
+    }
+}
+
+static void i2c_slave_transmit(const uint8_t *buffer, size_t size)
+{
+    printf("read %u byte(s):", static_cast<unsigned>(size));
+    for(size_t i = 0; i < size; i++) {
+        printf(" %02x", buffer[i]);
+    }
+    printf("\n");
+}
+
+// time stamp counter of the host or 0 if not available
+static inline uint64_t host_cycles()
+{
+    #if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+    #else
+        return 0;
+    #endif
+}
+
+// fade all channels and call _apply_fading() in a loop. the clock does not advance and no interrupt is executed
+static void benchmark_apply_fading(uint64_t calls)
+{
+    static constexpr uint16_t kBatchSize = 10000;
+    uint64_t nanos = 0;
+    uint64_t tsc = 0;
+    for(uint64_t done = 0; done < calls; done += kBatchSize) {
+        // fade in both directions with more steps than calls in each batch
+        float time = (kBatchSize + 1) / (2 * dimmer._get_frequency());
+        for(Dimmer::Channel::type i = 0; i < Dimmer::Channel::size(); i++) {
+            if (i % 2) {
+                dimmer.fade_channel_from_to(i, Dimmer::Level::max - 1, 1, time, true);
+            }
+            else {
+                dimmer.fade_channel_from_to(i, 1, Dimmer::Level::max - 1, time, true);
+            }
+        }
+        auto count = std::min<uint64_t>(kBatchSize, calls - done);
+        auto start = std::chrono::steady_clock::now();
+        auto startTsc = host_cycles();
+        for(uint64_t n = 0; n < count; n++) {
+            dimmer._apply_fading();
+        }
+        tsc += host_cycles() - startTsc;
+        nanos += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+    printf("_apply_fading() channels=%d calls=%" PRIu64 " host ns/call=%.1f host cycles/call=%.1f\n", Dimmer::Channel::size(), calls, nanos / static_cast<double>(calls), tsc / static_cast<double>(calls));
+}
+
+static void usage(const char *name)
+{
+    printf("usage: %s [options]\n\n", name);
+    printf("  -n, --halfwaves=N        half waves to simulate after the dimmer started (default 500)\n");
+    printf("  -f, --frequency=HZ       mains frequency (default 50)\n");
+    printf("  -j, --jitter=US          max. jitter of the zero crossing signal (default 0)\n");
+    printf("  -w, --pulse-width=US     width of the zero crossing pulse (default 200)\n");
+    printf("  -m, --missing=P          probability of a missing zero crossing pulse (default 0)\n");
+    printf("  -z, --noise=P            probability of a spike between two zero crossing pulses (default 0)\n");
+    printf("  -d, --drift=HZ           change of the frequency per second after the dimmer started (default 0)\n");
+    printf("  -l, --level=CH:LEVEL     set level\n");
+    printf("  -F, --fade=CH:FROM:TO:T[:CURVE]\n");
+    printf("                           fade channel, FROM can be -1 for the current level, CURVE is DIMMER_FADE_CURVE_*\n");
+    printf("  -C, --fade-channels=CH:TO:T[,CH:TO:T...]\n");
+    printf("                           fade several channels with DIMMER_COMMAND_FADE_CHANNELS\n");
+    #if DIMMER_HAVE_GROUPS
+        printf("  -g, --group=MASK:T:LEVEL[,LEVEL...]\n");
+        printf("                           send DIMMER_COMMAND_SET_GROUP_LEVELS to all groups, the dimmer joins group 1\n");
+    #endif
+    #if DIMMER_HAVE_SCENES
+        printf("  -x, --scene=LEVEL:T[,LEVEL:T...]\n");
+        printf("                           write scene 0 starting with channel 0 and recall it, -1 keeps the channel\n");
+    #endif
+    printf("  -r, --read=ADDR:LEN      read LEN bytes from the register ADDR after sending the commands\n");
+    #if DIMMER_HAVE_EVENT_LOG
+        printf("  -E, --event-log=SEQ      read the event log starting with SEQ after sending the commands\n");
+    #endif
+    #if DIMMER_HAVE_STATE_VERSION
+        printf("  -V, --changed=VERSION    read the channels changed since VERSION after sending the commands\n");
+    #endif
+    #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+        printf("  -k, --nack=N             do not acknowledge the first N events sent by the dimmer\n");
+    #endif
+    printf("  -o, --isr-overhead=N     clock cycles before an interrupt handler is executed (default %u)\n", isr_overhead_cycles);
+    printf("  -e, --max-error=N        exit with 1 if a gate edge deviates more than N clock cycles\n");
+    printf("  -c, --csv=FILE           write gate edges to FILE\n");
+    printf("  -s, --serial             echo serial output\n");
+    printf("  -S, --seed=N             seed for the random number generator\n");
+    printf("  -b, --benchmark=N        call _apply_fading() N times with all channels fading and exit\n");
+}
+
+int main(int argc, char **argv)
+{
+    static const struct option options[] = {
+        { "halfwaves", required_argument, nullptr, 'n' },
+        { "frequency", required_argument, nullptr, 'f' },
+        { "jitter", required_argument, nullptr, 'j' },
+        { "pulse-width", required_argument, nullptr, 'w' },
+        { "missing", required_argument, nullptr, 'm' },
+        { "noise", required_argument, nullptr, 'z' },
+        { "drift", required_argument, nullptr, 'd' },
+        { "level", required_argument, nullptr, 'l' },
+        { "fade", required_argument, nullptr, 'F' },
+        { "fade-channels", required_argument, nullptr, 'C' },
+        { "group", required_argument, nullptr, 'g' },
+        { "scene", required_argument, nullptr, 'x' },
+        { "read", required_argument, nullptr, 'r' },
+        { "nack", required_argument, nullptr, 'k' },
+        { "event-log", required_argument, nullptr, 'E' },
+        { "changed", required_argument, nullptr, 'V' },
+        { "isr-overhead", required_argument, nullptr, 'o' },
+        { "max-error", required_argument, nullptr, 'e' },
+        { "csv", required_argument, nullptr, 'c' },
+        { "serial", no_argument, nullptr, 's' },
+        { "seed", required_argument, nullptr, 'S' },
+        { "benchmark", required_argument, nullptr, 'b' },
+        { "help", no_argument, nullptr, 'h' },
+        { nullptr, 0, nullptr, 0 }
+    };
+
+    uint64_t halfwaves = 500;
+    double frequency = 50;
+    double jitter = 0;
+    double pulseWidth = 200;
+    double missing = 0;
+    double noise = 0;
+    double drift = 0;
+    int64_t maxError = -1;
+    uint32_t seed = 1;
+    uint64_t benchmark = 0;
+    // raw transactions sent to the dimmer after it has been started
+    std::vector<std::vector<uint8_t>> commands;
+    auto add_command = [&commands](const void *data, size_t size) -> std::vector<uint8_t> & {
+        auto ptr = reinterpret_cast<const uint8_t *>(data);
+        commands.emplace_back(ptr, ptr + size);
+        return commands.back();
+    };
+    // transaction that selects the data and the number of bytes to read
+    std::vector<std::pair<std::vector<uint8_t>, uint8_t>> reads;
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "n:f:j:w:m:z:d:l:F:C:g:x:r:k:E:V:o:e:c:sS:b:h", options, nullptr)) != -1) {
+        int channel, from, to;
+        int curve = DIMMER_FADE_CURVE_LINEAR;
+        float time;
+        switch (opt) {
+            case 'n':
+                halfwaves = strtoull(optarg, nullptr, 10);
+                break;
+            case 'f':
+                frequency = atof(optarg);
+                break;
+            case 'j':
+                jitter = atof(optarg);
+                break;
+            case 'd':
+                drift = atof(optarg);
+                break;
+            case 'w':
+                pulseWidth = atof(optarg);
+                break;
+            case 'm':
+                missing = atof(optarg);
+                break;
+            case 'z':
+                noise = atof(optarg);
+                break;
+            case 'l':
+                if (sscanf(optarg, "%d:%d", &channel, &to) != 2) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                {
+                    dimmer_command_fade_t command(channel, 0, to, 0);
+                    command.command = DIMMER_COMMAND_SET_LEVEL;
+                    add_command(&command, sizeof(command));
+                }
+                break;
+            case 'F':
+                if (sscanf(optarg, "%d:%d:%d:%f:%d", &channel, &from, &to, &time, &curve) < 4) {
+                    usage(argv[0]);
+                    return 2;
+                }
+                {
+                    dimmer_command_fade_curve_t command(channel, from, to, time, curve);
+                    add_command(&command, sizeof(command));
+                }
+                break;
+            case 'C': {
+                    uint8_t header[] = { DIMMER_REGISTER_COMMAND, DIMMER_COMMAND_FADE_CHANNELS };
+                    auto &data = add_command(header, sizeof(header));
+                    for(char *ptr = optarg; *ptr; ) {
+                        dimmer_fade_channel_t fade;
+                        if (sscanf(ptr, "%d:%d:%f", &channel, &to, &time) != 3) {
+                            usage(argv[0]);
+                            return 2;
+                        }
+                        fade = { static_cast<int8_t>(channel), static_cast<int16_t>(to), time };
+                        data.insert(data.end(), reinterpret_cast<uint8_t *>(&fade), reinterpret_cast<uint8_t *>(&fade) + sizeof(fade));
+                        ptr += strcspn(ptr, ",");
+                        if (*ptr == ',') {
+                            ptr++;
+                        }
+                    }
+                }
+                break;
+            #if DIMMER_HAVE_GROUPS
+                case 'g': {
+                        unsigned long long mask;
+                        int pos;
+                        if (sscanf(optarg, "%llx:%f:%n", &mask, &time, &pos) != 2) {
+                            usage(argv[0]);
+                            return 2;
+                        }
+                        dimmer_command_group_levels_t command(DIMMER_GROUP_ALL, mask, time);
+                        auto &data = add_command(&command, sizeof(command));
+                        for(char *ptr = optarg + pos; *ptr; ) {
+                            int16_t level = strtol(ptr, &ptr, 10);
+                            data.insert(data.end(), reinterpret_cast<uint8_t *>(&level), reinterpret_cast<uint8_t *>(&level) + sizeof(level));
+                            if (*ptr == ',') {
+                                ptr++;
+                            }
+                        }
+                    }
+                    break;
+            #endif
+            #if DIMMER_HAVE_SCENES
+                case 'x': {
+                        uint8_t header[] = { DIMMER_REGISTER_COMMAND, DIMMER_COMMAND_WRITE_SCENE, 0, 0 };
+                        auto &data = add_command(header, sizeof(header));
+                        for(char *ptr = optarg; *ptr; ) {
+                            dimmer_scene_channel_t channel;
+                            channel.level = strtol(ptr, &ptr, 10);
+                            channel.time = (*ptr == ':') ? strtof(ptr + 1, &ptr) * 100 : 0;
+                            data.insert(data.end(), reinterpret_cast<uint8_t *>(&channel), reinterpret_cast<uint8_t *>(&channel) + sizeof(channel));
+                            if (*ptr == ',') {
+                                ptr++;
+                            }
+                        }
+                        uint8_t recall[] = { DIMMER_REGISTER_COMMAND, DIMMER_COMMAND_RECALL_SCENE, 0 };
+                        add_command(recall, sizeof(recall));
+                    }
+                    break;
+            #endif
+            case 'r': {
+                    unsigned address, length;
+                    if (sscanf(optarg, "%i:%u", &address, &length) != 2) {
+                        usage(argv[0]);
+                        return 2;
+                    }
+                    reads.emplace_back(std::vector<uint8_t>({ DIMMER_REGISTER_READ_LENGTH, static_cast<uint8_t>(length), static_cast<uint8_t>(address) }), length);
+                }
+                break;
+            #if DIMMER_HAVE_EVENT_LOG
+                case 'E': {
+                        uint16_t sequence = strtoul(optarg, nullptr, 0);
+                        reads.emplace_back(std::vector<uint8_t>({ DIMMER_REGISTER_COMMAND, DIMMER_COMMAND_READ_EVENT_LOG, static_cast<uint8_t>(sequence), static_cast<uint8_t>(sequence >> 8) }), DIMMER_EVENT_LOG_READ_SIZE);
+                    }
+                    break;
+            #endif
+            #if DIMMER_HAVE_STATE_VERSION
+                case 'V': {
+                        uint16_t version = strtoul(optarg, nullptr, 0);
+                        reads.emplace_back(std::vector<uint8_t>({ DIMMER_REGISTER_COMMAND, DIMMER_COMMAND_READ_CHANGED_CHANNELS, static_cast<uint8_t>(version), static_cast<uint8_t>(version >> 8) }), DIMMER_CHANGED_CHANNELS_READ_SIZE);
+                    }
+                    break;
+            #endif
+            #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+                case 'k':
+                    twi_nack_master(atoi(optarg));
+                    break;
+            #endif
+            case 'o':
+                isr_overhead_cycles = atoi(optarg);
+                break;
+            case 'e':
+                maxError = atoll(optarg);
+                break;
+            case 'c':
+                if ((csv = fopen(optarg, "wt")) == nullptr) {
+                    perror(optarg);
+                    return 2;
+                }
+                fprintf(csv, "cycle,channel,state,zc_offset_us\n");
+                break;
+            case 's':
+                echo_serial = true;
+                break;
+            case 'S':
+                seed = strtoul(optarg, nullptr, 10);
+                break;
+            case 'b':
+                benchmark = strtoull(optarg, nullptr, 10);
+                break;
+            default:
+                usage(argv[0]);
+                return opt == 'h' ? 0 : 2;
+        }
+    }
+
+    for(auto &stats: channel_stats) {
+        stats = {};
+        stats.width_min = kNever;
+        stats.delay_min = kNever;
+        stats.error_min = INT64_MAX;
+        stats.error_max = INT64_MIN;
+    }
+
+    // ~25°C for the internal sensor and NTC, 3.3V VCC
+    adc_values[8] = 267;
+    adc_values[14] = 341;
+    #if HAVE_NTC
+        adc_values[NTC_PIN - A0] = 1023.0 * NTC_SERIES_RESISTANCE / (NTC_SERIES_RESISTANCE + NTC_NOMINAL_RESISTANCE);
+    #endif
+
+    on_port_change = port_change;
+    on_serial_write = serial_write;
+    on_i2c_master_transmit = i2c_master_transmit;
+    on_i2c_slave_transmit = i2c_slave_transmit;
+
+    MainsSource source(frequency, jitter, pulseWidth, missing, noise, drift, seed);
+    mains = &source;
+    set_pin(ZC_SIGNAL_PIN, !kZCActiveLevel);
+    set_source(&source);
+
+    // Arduino's main()
+    cpu.enable_interrupts();
+    setup();
+
+    uint64_t startHalfwave = 0;
+    while (!recording || source.count() - startHalfwave < halfwaves) {
+        loop();
+        #if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+            frame_feed();
+        #endif
+        serialEvent();
+        check_ports();
+
+        if (!recording && measure == nullptr && dimmer.halfwave_ticks) {
+            if (benchmark) {
+                benchmark_apply_fading(benchmark);
+                return 0;
+            }
+            #if DIMMER_HAVE_GROUPS
+                conf.config().group = { 1, 0 };
+            #endif
+            for(const auto &command: commands) {
+                // group commands are sent to the general call address
+                static constexpr auto kCommandOffset = offsetof(dimmer_command_group_levels_t, command);
+                bool generalCall = DIMMER_HAVE_GROUPS && command.size() > kCommandOffset && command[0] == DIMMER_REGISTER_TIME && command[kCommandOffset] == DIMMER_COMMAND_SET_GROUP_LEVELS;
+                queue_write(generalCall ? DIMMER_I2C_GENERAL_CALL_ADDRESS : DIMMER_I2C_ADDRESS, command.data(), command.size());
+            }
+            for(const auto &read: reads) {
+                queue_write(DIMMER_I2C_ADDRESS, read.first.data(), read.first.size());
+                queue_read(DIMMER_I2C_ADDRESS, read.second);
+            }
+            recording = true;
+            startHalfwave = source.count();
+        }
+        else if (!recording && millis() > 10000) {
+            printf("dimmer did not start\n");
+            return 1;
+        }
+    }
+
+    printf("\nsimulated %.3fs, %" PRIu64 " half waves @ %.3fHz, isr overhead %u cycles\n\n", cycles / static_cast<double>(F_CPU), source.count(), frequency, isr_overhead_cycles);
+
+    printf("channel   pulses    width min/avg/max (us)        zc to gate on min/avg/max (us)   edge error min/max (cycles)\n");
+    int64_t worstError = 0;
+    for(Dimmer::Channel::type i = 0; i < Dimmer::Channel::size(); i++) {
+        const auto &stats = channel_stats[i];
+        if (!stats.pulses) {
+            printf("%7d %8d\n", i, 0);
+            continue;
+        }
+        printf("%7d %8" PRIu64 " %9.2f %9.2f %9.2f   %9.2f %9.2f %9.2f", i, stats.pulses,
+            stats.width_min / kCyclesPerMicro, stats.width_sum / kCyclesPerMicro / stats.pulses, stats.width_max / kCyclesPerMicro,
+            stats.delay_min / kCyclesPerMicro, stats.delay_sum / kCyclesPerMicro / stats.delay_count, stats.delay_max / kCyclesPerMicro);
+        if (stats.error_min <= stats.error_max) {
+            printf("   %9" PRId64 " %9" PRId64, stats.error_min, stats.error_max);
+            worstError = std::max({ worstError, -stats.error_min, stats.error_max });
+        }
+        printf("\n");
+    }
+
+    printf("\nvector            calls   host ns avg      max\n");
+    for(uint8_t i = 0; i < static_cast<uint8_t>(Vector::kSize); i++) {
+        const auto &stats = vector_stats[i];
+        if (stats.count) {
+            printf("%-14s %8" PRIu64 " %9.1f %9" PRIu64 "\n", get_vector_name(static_cast<Vector>(i)), stats.count, stats.host_nanos / static_cast<double>(stats.count), stats.host_nanos_max);
+        }
+    }
+
+    #if HAVE_ISR_STATS
+        // simulated clock cycles as reported by DIMMER_COMMAND_READ_ISR_STATS
+        static const char *isrNames[] = { "COMPARE_A", "COMPARE_B", "ZC", "ADC", "TWI" };
+        printf("\nISR stats        calls   cycles min/avg/max   latency avg/max   histogram\n");
+        for(uint8_t i = 0; i < static_cast<uint8_t>(Dimmer::IsrType::MAX); i++) {
+            dimmer_isr_stats_t stats;
+            dimmer_isr_histogram_t histogram;
+            Dimmer::isr_stats[i].get(stats);
+            Dimmer::isr_stats[i].get(histogram);
+            printf("%-14s %7u %6u %6u %6u %8u %8u  ", isrNames[i], stats.count, stats.min, stats.avg, stats.max, stats.latency_avg, stats.latency_max);
+            for(uint8_t j = 0; j < sizeof(histogram.counts) / sizeof(histogram.counts[0]); j++) {
+                printf(" %u", histogram.counts[j]);
+            }
+            printf("\n");
+        }
+    #endif
+
+    printf("\nevents sent to 0x%02x:", DIMMER_I2C_MASTER_ADDRESS);
+    for(int i = 0; i < 256; i++) {
+        if (event_count[i]) {
+            printf(" 0x%02x=%" PRIu64, i, event_count[i]);
+        }
+    }
+    #if DIMMER_HAVE_EVENT_QUEUE
+        printf("\nevent queue: overflow=%u failed=%u", error_counters.event_queue_overflow, error_counters.event_send_failed);
+    #endif
+    #if DIMMER_ZC_FILTER
+        printf("\nzc filter: blanked=%u pulse width=%u interval=%u", error_counters.zc_blanked, error_counters.zc_pulse_width, error_counters.zc_interval);
+    #endif
+    #if ENABLE_ZC_PREDICTION
+        dimmer_zc_pll_t pll;
+        dimmer.zc_pll.get(pll);
+        printf("\nzc pll: %.4fHz (mains %.4fHz) phase error=%.2fus avg=%.2fus rejected=%u missed=%u flywheel=%u locked=%u", (F_CPU / 2.0) / (pll.period / 256.0), source.frequency(),
+            pll.phase_error / kCyclesPerMicro, pll.avg_phase_error / kCyclesPerMicro, pll.rejected, pll.missed, pll.flywheel, pll.locked);
+    #endif
+    printf("\nEEPROM bytes written: %u\n", EEPROM._getWrites());
+    #if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+        if (serial_frames.bytes) {
+            printf("serial frames: %u byte(s) received in %.3fms, %u byte(s) as +I2CT= text\n", static_cast<unsigned>(serial_frames.bytes),
+                (serial_frames.last - serial_frames.start) / kCyclesPerMicro / 1000.0, static_cast<unsigned>(serial_frames.text_bytes));
+        }
+    #endif
+
+    if (csv) {
+        fclose(csv);
+    }
+
+    if (maxError >= 0 && worstError > maxError) {
+        printf("\nedge error %" PRId64 " exceeds %" PRId64 " cycles\n", worstError, maxError);
+        return 1;
+    }
+    return 0;
+}
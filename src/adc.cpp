@@ -3,6 +3,7 @@
  */
 
 #include "adc.h"
+#include "isr_stats.h"
 
 ADCHandler _adc;
 
@@ -11,6 +12,7 @@ ADCHandler _adc;
 // this will be executed every kADCSRA_ReadTimeMicros microseconds and blocks interrupts for some time
 ISR(ADC_vect)
 {
+    ISR_STATS_SCOPE(ADC_COMPLETE);
     _adc.adc_handler(ADC);
 }
 
@@ -16,11 +16,13 @@ void Config::initRegisterMem() const
 {
     register_mem = {};
     register_mem.data.from_level = Dimmer::Level::invalid;
+    dimmer.set_channels_dirty();
 }
 
 void Config::copyToRegisterMem(const register_mem_cfg_t &config) const
 {
     register_mem.data.cfg = config;
+    dimmer.set_channels_dirty();
 }
 
 void Config::copyFromRegisterMem(register_mem_cfg_t &config)
@@ -38,6 +40,7 @@ void Config::copyFromRegisterMem(register_mem_cfg_t &config)
     void Config::copyToInterpolation() const
     {
         cubicInterpolation.copyFromConfig(_config.cubic_int);
+        dimmer.set_channels_dirty();
     }
 
     void Config::copyFromInterpolation()
@@ -77,6 +80,16 @@ void Config::resetConfig()
     #if DIMMER_CUBIC_INTERPOLATION
         resetInterpolation();
     #endif
+    #if DIMMER_HAVE_GROUPS
+        _config.group = { DIMMER_GROUP_ID, DIMMER_GROUP_CHANNEL_OFFSET };
+    #endif
+    #if DIMMER_HAVE_SCENES
+        for(auto &scene: _config.scenes.scenes) {
+            for(auto &channel: scene) {
+                channel = { Dimmer::Level::invalid, 0 };
+            }
+        }
+    #endif
 }
 
 void Config::initEEPROM()
@@ -248,10 +261,7 @@ void Config::_writeConfig(bool force)
     event.write_position = _eeprom_position;
 
     _D(5, debug_printf("eeprom written event: cycle %lu:%u, written %u\n", event.write_cycle, event.write_position, event.bytes_written));
-    Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
-    Wire.write(DIMMER_EVENT_EEPROM_WRITTEN);
-    Wire.write(reinterpret_cast<const uint8_t *>(&event), sizeof(event));
-    Wire.endTransmission();
+    Dimmer::DimmerEvent<DIMMER_EVENT_EEPROM_WRITTEN>::send(event);
 
     Serial.printf_P(PSTR("+REM=EEPROMW,c=%lu,p=%u,n=%lu,w=%u,f=%u,crc=%04x,cfg=%u\n"),
         event.write_cycle,
@@ -25,9 +25,15 @@ struct __attribute__((__packed__)) EEPROM_config_t {
     };
     register_mem_cfg_t cfg;
     register_mem_channels_t channels;
+    #if DIMMER_HAVE_SCENES
+        dimmer_config_scenes_t scenes;
+    #endif
     #if DIMMER_CUBIC_INTERPOLATION
         dimmer_config_cubic_int_t cubic_int;
     #endif
+    #if DIMMER_HAVE_GROUPS
+        dimmer_config_group_t group;
+    #endif
 
     bool operator==(const EEPROM_config_t &config) const {
         return memcmp(this, &config, sizeof(*this)) == 0;
@@ -94,7 +100,6 @@ public:
 
     EEPROM_config_t &config();
 
-    Dimmer::Level::type &level(Dimmer::Channel::type channel);
     Dimmer::Level::type level(Dimmer::Channel::type channel) const;
 
 private:
@@ -153,11 +158,6 @@ inline EEPROM_config_t &Config::config()
     return _config;
 }
 
-inline Dimmer::Level::type &Config::level(Dimmer::Channel::type channel)
-{
-    return _config.channels.level[channel];
-}
-
 inline Dimmer::Level::type Config::level(Dimmer::Channel::type channel) const
 {
     return _config.channels.level[channel];
@@ -94,18 +94,41 @@ uint8_t CubicInterpolation::getInterpolatedLevels(Dimmer::Level::type *dstPtr, D
     return size;
 }
 
-Dimmer::Level::type CubicInterpolation::_toLevel(double y) const
+Dimmer::Level::type CubicInterpolation::_toLevel(double y)
 {
     return std::clamp<Dimmer::Level::type>((y * ((DIMMER_MAX_LEVEL - 1) / 255.0) + 0.5 /*round*/), 0, DIMMER_MAX_LEVEL - 1);
 }
 
-double CubicInterpolation::_toY(Dimmer::Level::type level) const
+double CubicInterpolation::_toY(Dimmer::Level::type level)
 {
     return std::min<double>(static_cast<uint16_t>(level) / ((DIMMER_MAX_LEVEL - 1) / 255.0), 255);
 }
 
+void CubicInterpolation::update()
+{
+    bool enabled = false;
+    DIMMER_CHANNEL_LOOP(channel) {
+        if (_channels[channel].update()) {
+            dimmer.set_channels_dirty(1 << channel);
+        }
+        _D(5, debug_printf("cubic int channel=%u size=%u\n", channel, _channels[channel].size()));
+        if (_channels[channel].size()) {
+            enabled = true;
+        }
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        register_mem.data.cfg.bits.cubic_interpolation = enabled;
+    }
+}
+
 void CubicInterpolation::Channel::copyToConfig(register_mem_cubic_int_t &cubicInt)
 {
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (_hasPending) {
+            cubicInt = _pending;
+            return;
+        }
+    }
     cubicInt = {};
     auto ptr = &cubicInt.points[0];
     for(uint8_t i = 0; i < size(); i++) {
@@ -126,13 +149,45 @@ void CubicInterpolation::Channel::createFromConfig(const register_mem_cubic_int_
         }
         maxX = (points++)->x;
     }
-    if (allocate(count)) {
+    // the table is created with interrupts enabled and swapped with the current data
+    Channel channel;
+    if (channel.allocate(count)) {
         points = &cubicInt.points[0];
         for (uint8_t i = 0; i < count; i++) {
-            setDataPoint(i, points->x, points->y);
+            channel.setDataPoint(i, points->x, points->y);
             points++;
         }
+        channel._createTable();
+    }
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        std::swap(_xValues, channel._xValues);
+        std::swap(_yValues, channel._yValues);
+        std::swap(_levels, channel._levels);
+        std::swap(_dataPoints, channel._dataPoints);
+    }
+    // the destructor releases the previous data
+}
+
+bool CubicInterpolation::Channel::update()
+{
+    register_mem_cubic_int_t cubicInt;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        if (!_hasPending) {
+            return false;
+        }
+        cubicInt = _pending;
+        _hasPending = false;
+    }
+    createFromConfig(cubicInt);
+    return true;
+}
+
+void CubicInterpolation::Channel::_createTable()
+{
+    for(uint16_t i = 0; i < kTableSize; i++) {
+        _levels[i] = _toLevel(Interpolation::DIMMER_INTERPOLATION_METHOD(_xValues, _yValues, _dataPoints, _toY(i << kShift)));
     }
+    _D(5, debug_printf("cubic int table min=%d max=%d\n", _levels[0], _levels[kTableSize - 1]));
 }
 
 #endif
@@ -7,6 +7,7 @@
 #if DIMMER_CUBIC_INTERPOLATION
 
 #include <Arduino.h>
+#include <util/atomic.h>
 #include "dimmer_def.h"
 #include <InterpolationLib.h>
 #include "dimmer.h"
@@ -18,6 +19,13 @@ public:
     using ChannelType = Dimmer::Channel::type;
     using LevelType = Dimmer::Level::type;
 
+    // piecewise linear table of the spline
+    static constexpr uint8_t kShift = DIMMER_CUBIC_INT_TABLE_SHIFT;
+    static constexpr uint16_t kMask = (1 << kShift) - 1;
+    static constexpr uint16_t kTableSize = (Dimmer::Level::max >> kShift) + 2;
+
+    static_assert(kShift >= 1 && kShift <= 8, "DIMMER_CUBIC_INT_TABLE_SHIFT out of range");
+
 public:
     class Channel {
     public:
@@ -39,14 +47,30 @@ public:
 
         xyValueTypePtr getXValues() const;
         xyValueTypePtr getYValues() const;
+        // nullptr if the channel has no data points
+        const LevelType *getLevels() const;
 
+        // returns the data points that have not been applied by update() yet
         void copyToConfig(register_mem_cubic_int_t &cubicInt);
+        // the new data points and table are created before they replace the current ones. the table takes
+        // several milliseconds and must not be created inside an interrupt
         void createFromConfig(const register_mem_cubic_int_t &cubicInt);
+        // store the data points, the table is created by update()
+        void setConfig(const register_mem_cubic_int_t &cubicInt);
+        // create the table from the stored data points, returns false if there was nothing to update
+        bool update();
+
+    private:
+        void _createTable();
 
     public:
-        xyValueTypePtr _xValues;
-        xyValueTypePtr _yValues;
-        uint8_t _dataPoints;
+        xyValueTypePtr _xValues{nullptr};
+        xyValueTypePtr _yValues{nullptr};
+        LevelType *_levels{nullptr};
+        uint8_t _dataPoints{0};
+        // data points of setConfig()
+        register_mem_cubic_int_t _pending;
+        volatile bool _hasPending{false};
     };
 
 public:
@@ -65,14 +89,16 @@ public:
 
     void copyFromConfig(const dimmer_config_cubic_int_t &cubicInt);
     void copyToConfig(dimmer_config_cubic_int_t &cubicInt);
+    // called from loop() to create the tables of the data points received with DIMMER_COMMAND_WRITE_CUBIC_INT
+    void update();
     void clear();
     void printConfig() const;
 
     Channel &getChannel(ChannelType channel);
 
 private:
-    LevelType _toLevel(double y) const;
-    double _toY(LevelType level) const;
+    static LevelType _toLevel(double y);
+    static double _toY(LevelType level);
 
     Channel _channels[DIMMER_CHANNEL_COUNT];
 };
@@ -88,12 +114,22 @@ inline CubicInterpolation::xyValueTypePtr CubicInterpolation::Channel::getYValue
     return _yValues;
 }
 
+inline const CubicInterpolation::LevelType *CubicInterpolation::Channel::getLevels() const
+{
+    return _levels;
+}
+
 inline bool CubicInterpolation::Channel::allocate(uint8_t dataPoints)
 {
     free();
     if (dataPoints > 1) {
-        _dataPoints = dataPoints;
         _xValues = new xyValueType[dataPoints << 1]();
+        _levels = new LevelType[kTableSize];
+        if (!_xValues || !_levels) {
+            free();
+            return false;
+        }
+        _dataPoints = dataPoints;
         _yValues = &_xValues[dataPoints];
     }
     return (_xValues != nullptr);
@@ -106,6 +142,10 @@ inline void CubicInterpolation::Channel::free()
         _xValues = nullptr;
         _yValues = nullptr;
     }
+    if (_levels) {
+        delete[] _levels;
+        _levels = nullptr;
+    }
     _dataPoints = 0;
 }
 
@@ -122,23 +162,33 @@ inline uint8_t CubicInterpolation::Channel::size() const
     return _dataPoints;
 }
 
+inline void CubicInterpolation::Channel::setConfig(const register_mem_cubic_int_t &cubicInt)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _pending = cubicInt;
+        _hasPending = true;
+    }
+}
+
 inline CubicInterpolation::CubicInterpolation() :
     _channels()
 {
 }
 
+// levels outside Level::min - Level::max are converted like Level::max
 inline CubicInterpolation::LevelType CubicInterpolation::getLevel(LevelType level, ChannelType channelNum) const
 {
-    auto &channel = _channels[channelNum];
-    if (channel.size()) {
-        return _toLevel(Interpolation::DIMMER_INTERPOLATION_METHOD(channel.getXValues(), channel.getYValues(), channel.size(), _toY(level)));
+    auto levels = _channels[channelNum].getLevels();
+    if (levels) {
+        uint16_t value = std::min<uint16_t>(level, Dimmer::Level::max);
+        auto ptr = &levels[value >> kShift];
+        return ptr[0] + static_cast<LevelType>((static_cast<int32_t>(ptr[1] - ptr[0]) * (value & kMask)) >> kShift);
     }
     return level;
 }
 
 inline void CubicInterpolation::copyFromConfig(const dimmer_config_cubic_int_t &cubicInt)
 {
-    clear();
     DIMMER_CHANNEL_LOOP(channel) {
         _channels[channel].createFromConfig(cubicInt.channels[channel]);
     }
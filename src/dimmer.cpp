@@ -6,6 +6,7 @@
 #include "dimmer.h"
 #include "measure_frequency.h"
 #include "i2c_slave.h"
+#include "isr_stats.h"
 
 #include <string.h>
 #include <stdlib.h>
@@ -19,10 +20,12 @@ DimmerBase dimmer(register_mem.data);
 #endif
 constexpr const uint8_t Dimmer::Channel::pins[Channel::size()];
 
+uint8_t Ports::index[Channel::size()];
+uint8_t dimmer_pins_mask[Channel::size()];
+
 #if not HAVE_CHANNELS_INLINE_ASM
 
     volatile uint8_t *dimmer_pins_addr[Channel::size()];
-    uint8_t dimmer_pins_mask[Channel::size()];
 
 #else
 
@@ -43,12 +46,14 @@ constexpr const uint8_t Dimmer::Channel::pins[Channel::size()];
 // compare a is used for switching the mosfets
 ISR(TIMER1_COMPA_vect)
 {
+    ISR_STATS_SCOPE_LATENCY(COMPARE_A, (TCNT1 - OCR1A) * Timer<1>::prescaler);
     dimmer.compare_interrupt();
 }
 
 // compare b is used for the delayed start
 ISR(TIMER1_COMPB_vect)
 {
+    ISR_STATS_SCOPE_LATENCY(COMPARE_B, (TCNT1 - OCR1B) * Timer<1>::prescaler);
     dimmer._start_halfwave();
 }
 
@@ -60,7 +65,6 @@ MeasureTimer timer2;
 ISR(TIMER2_OVF_vect)
 {
     timer2._overflow++;
-    // the artificial zc event is sent 10 microseconds earlier, so this code can be executed before
     #if HAVE_FADE_COMPLETION_EVENT
         if (queues.fading_completed_events.timer > 0) {
             queues.fading_completed_events.timer--;
@@ -69,43 +73,36 @@ ISR(TIMER2_OVF_vect)
     if (queues.check_temperature.timer > 0) {
         queues.check_temperature.timer--;
     }
-    #if ENABLE_ZC_PREDICTION && 0
-        // send artificial event in case the event is not received within the range
-        // in case the zero crossing overlaps with this event, the event is filtered
-        uint32_t ticks = timer2.get_timer();
-        uint32_t dur = ticks - dimmer.last_ticks;
-        if (dur >= dimmer.halfwave_ticks_timer2) {
-            dimmer.zc_interrupt_handler(timer2.get_timer(), false);
-            #if DEBUG_ZC_PREDICTION
-                dimmer.debug_pred.pred_signals++;
-            #endif
+    #if ENABLE_ZC_PREDICTION && DIMMER_ZC_FLYWHEEL_HALFWAVES
+        // send artificial event if there was no valid edge within the max. phase error of the predicted
+        // zero crossing
+        if (dimmer.zc_pll.isFlywheelDue(timer2._overflow)) {
+            dimmer.zc_flywheel_handler();
         }
     #endif
 }
 
-static constexpr uint8_t kMicrosThresholdInCycles = microsecondsToClockCycles(5) * MeasureTimer::prescaler;
+#if DIMMER_ZC_INPUT_CAPTURE
+
+    void (*Dimmer::zc_capture_handler)();
+
+    ISR(TIMER1_CAPT_vect)
+    {
+        zc_capture_handler();
+    }
+
+#endif
 
 #if ENABLE_ZC_PREDICTION
 
-    void DimmerBase::set_halfwave_ticks(uint24_t ticks)
+    void DimmerBase::update_frequency()
     {
-        int32_t diff = halfwave_ticks_timer2 - ticks;
-        if (diff < 0) {
-            diff = -diff;
-        }
-        if (diff > kMicrosThresholdInCycles) {
-            #if DEBUG_ZC_PREDICTION
-                Serial.printf_P(PSTR("+REM=o=%ld,n=%ld\n"), (long)halfwave_ticks_timer2, (long)ticks);
-                Serial.flush();
-            #endif
-            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-                halfwave_ticks_timer2 = ticks;
-                FrequencyMeasurement::_calc_halfwave_min_max(halfwave_ticks_timer2, halfwave_ticks_min, halfwave_ticks_max);
-                halfwave_ticks = ticks / Timer<1>::prescaler;
-            }
-            sync_event.halfwave_micros = Timer<1>::ticksToMicros(halfwave_ticks);
-            set_frequency((F_CPU / 2.0) / ticks);
+        uint32_t period;
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            period = zc_pll.period();
         }
+        sync_event.halfwave_micros = clockCyclesToMicroseconds(period);
+        set_frequency((F_CPU / 2.0) / period);
     }
 
 #endif
@@ -115,35 +112,40 @@ void DimmerBase::begin()
     if (!isValidFrequency(register_mem.data.metrics.frequency)) {
         return;
     }
-    halfwave_ticks = ((F_CPU / Timer<1>::prescaler / 2.0) / register_mem.data.metrics.frequency);
+    // round to timer 1 ticks
+    halfwave_ticks = (halfwave_cycles + (static_cast<uint32_t>(Timer<1>::prescaler) << 7)) / (static_cast<uint32_t>(Timer<1>::prescaler) << 8);
+    set_channels_dirty();
     #if ENABLE_ZC_PREDICTION
-        // calculate clock cycles for timer2 that executes the prediction
-        halfwave_ticks_timer2 = ((F_CPU / 2.0) / register_mem.data.metrics.frequency);
-        halfwave_ticks_integral = halfwave_ticks_timer2;
-        FrequencyMeasurement::_calc_halfwave_min_max(halfwave_ticks_timer2, halfwave_ticks_min, halfwave_ticks_max);
+        // clock cycles of timer2 per half wave
+        zc_pll.begin(halfwave_cycles);
         sync_event = { 0 , Timer<1>::ticksToMicros(halfwave_ticks) };
     #endif
+    #if DIMMER_ZC_FILTER
+        zc_filter.begin();
+    #endif
 
     #if DEBUG_ZC_PREDICTION
-        Serial.printf_P(PSTR("+REM=%uus,r=%ld-%ld:%ld\n"), sync_event.halfwave_micros, (long)halfwave_ticks_min, (long)halfwave_ticks_max, (long)halfwave_ticks_timer2);
+        Serial.printf_P(PSTR("+REM=%uus,p=%ld\n"), sync_event.halfwave_micros, (long)zc_pll.period());
         Serial.flush();
     #endif
 
    queues.scheduled_calls = {};
     #if DIMMER_USE_QUEUE_LEVELS
-        queues.levels = {};
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            queues.levels.clear();
+        }
     #endif
 
     toggle_state = DIMMER_MOSFET_OFF_STATE;
 
     DIMMER_CHANNEL_LOOP(i) {
+        auto addr = portOutputRegister(digitalPinToPort(Channel::pins[i]));
+        dimmer_pins_mask[i] = Ports::mask(Channel::pins[i]);
         #if !HAVE_CHANNELS_INLINE_ASM
-            dimmer_pins_mask[i] = digitalPinToBitMask(Channel::pins[i]);
-            dimmer_pins_addr[i] = portOutputRegister(digitalPinToPort(Channel::pins[i]));
-            _D(5, debug_printf("ch=%u pin=%u addr=%02x mask=%02x\n", i, Channel::pins[i], dimmer_pins_addr[i], dimmer_pins_mask[i]));
-        #else
-            _D(5, debug_printf("ch=%u pin=%u\n", i, Channel::pins[i]));
+            dimmer_pins_addr[i] = addr;
         #endif
+        Ports::index[i] = Ports::offset(Ports::port(Channel::pins[i]));
+        _D(5, debug_printf("ch=%u pin=%u port=%u addr=%02x mask=%02x\n", i, Channel::pins[i], Ports::index[i], addr, dimmer_pins_mask[i]));
         #if HAVE_FADE_COMPLETION_EVENT
             fading_completed[i] = Level::invalid;
         #endif
@@ -159,25 +161,55 @@ void DimmerBase::begin()
         // timer2 runs at clock speed 
         timer2.begin(); 
         // the order here is not so important, the first ZC event will be filtered if prediction is enabled
-        attachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN), []() {
-
-            dimmer.zc_interrupt_handler(
-                #if ENABLE_ZC_PREDICTION
-                    // get clock cycles since last event to filter invalid signals
-                    timer2.get_timer(),
-                #else
-                    0,
+        #if DIMMER_ZC_INPUT_CAPTURE
+            zc_capture_handler = []() {
+
+                // TCNT1 is reset when the half wave starts after the ZC delay. if this happened before the
+                // interrupt was executed, the latency is unknown
+                uint16_t latency = TCNT1 - ICR1;
+                if (latency >= 0x8000) {
+                    latency = 0;
+                }
+                ISR_STATS_SCOPE_LATENCY(ZERO_CROSSING, latency * Timer<1>::prescaler);
+                dimmer.zc_interrupt_handler(
+                    #if ENABLE_ZC_PREDICTION || DIMMER_ZC_FILTER
+                        // clock cycles of the edge
+                        timer2.get_timer() - static_cast<uint32_t>(latency) * Timer<1>::prescaler,
+                    #else
+                        0,
+                    #endif
+                    latency
+                );
+                #if DEBUG_ZC_PREDICTION
+                    dimmer.debug_pred.zc_signals++;
                 #endif
-                true
-            );            
-            #if DEBUG_ZC_PREDICTION
-                dimmer.debug_pred.zc_signals++;
-            #endif
-            
-        }, DIMMER_ZC_INTERRUPT_MODE);
+
+            };
+        #else
+            attachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN), []() {
+
+                ISR_STATS_SCOPE(ZERO_CROSSING);
+                dimmer.zc_interrupt_handler(
+                    #if ENABLE_ZC_PREDICTION || DIMMER_ZC_FILTER
+                        // get clock cycles since last event to filter invalid signals
+                        timer2.get_timer(),
+                    #else
+                        0,
+                    #endif
+                    0
+                );
+                #if DEBUG_ZC_PREDICTION
+                    dimmer.debug_pred.zc_signals++;
+                #endif
+
+            }, DIMMER_ZC_INTERRUPT_MODE);
+        #endif
 
         _D(5, debug_printf("starting timer\n"));
         Timer<1>::begin<Timer<1>::kIntMaskAll, nullptr>();
+        #if DIMMER_ZC_INPUT_CAPTURE
+            Timer<1>::capture_begin<kZCCaptureMode>();
+        #endif
     }
 }
 
@@ -188,10 +220,13 @@ void DimmerBase::end()
     ATOMIC_BLOCK(ATOMIC_FORCEON) {
         queues.scheduled_calls = {};
         #if DIMMER_USE_QUEUE_LEVELS
-            queues.levels = {};
+            queues.levels.clear();
         #endif
 
-        detachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN));
+        #if !DIMMER_ZC_INPUT_CAPTURE
+            detachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN));
+        #endif
+        // disables the input capture interrupt
         Timer<1>::end();
         DIMMER_CHANNEL_LOOP(i) {
             digitalWrite(Channel::pins[i], DIMMER_MOSFET_OFF_STATE);
@@ -201,36 +236,100 @@ void DimmerBase::end()
     }
 }
 
-void DimmerBase::zc_interrupt_handler(uint32_t ticks, bool integrate)
+#if ENABLE_ZC_PREDICTION
+
+    // offset       clock cycles from the filtered zero crossing
+    static inline uint16_t get_zero_crossing_delay(int16_t offset)
+    {
+        uint16_t delay = register_mem.data.cfg.zero_crossing_delay_ticks;
+        int16_t offsetTicks = offset / static_cast<int16_t>(Timer<1>::prescaler);
+        return (offsetTicks < static_cast<int16_t>(delay)) ? delay - offsetTicks : 0;
+    }
+
+#endif
+
+void DimmerBase::zc_interrupt_handler(uint32_t ticks, uint16_t latency)
 {
-    #if ENABLE_ZC_PREDICTION
-        // get clock cycles since last call of this method
-        uint32_t dur = ticks - last_ticks;
-        last_ticks = ticks;
+    #if DIMMER_ZC_FILTER
+        if (!zc_filter.accept(ticks, latency, static_cast<uint32_t>(halfwave_ticks) * Timer<1>::prescaler)) {
+            return;
+        }
+    #endif
+
+    uint16_t delay = register_mem.data.cfg.zero_crossing_delay_ticks;
 
-        // check if the ticks since the last call are in range
-        if (!is_ticks_within_range(dur)) {
-            // invalid signal
-            sync_event.invalid_signals++;
+    #if ENABLE_ZC_PREDICTION
+        // clock cycles from the filtered zero crossing to the edge
+        int16_t offset;
+        auto result = zc_pll.update(ticks, offset);
+        if (result == ZeroCrossingPll::Result::VALID) {
+            // the signal seems valid, reset counter
+            sync_event.invalid_signals = 0;
+
+            // start the half wave relative to the filtered zero crossing
+            delay = get_zero_crossing_delay(offset);
+
+            // follow the filtered period with every valid edge in case the mains frequency or the clock cycles
+            // change due to heat. the channels are recalculated only if the rounded number of ticks changes. the
+            // ticks table has its own deadband and is not rebuilt for changes below kTicksTableDeadband
+            TickType period_ticks = (zc_pll.period() + (Timer<1>::prescaler / 2)) / Timer<1>::prescaler;
+            if (period_ticks != halfwave_ticks) {
+                halfwave_ticks = period_ticks;
+                dirty_channels = kAllChannelsMask;
+            }
+        }
+        else if (result == ZeroCrossingPll::Result::REJECTED) {
+            if (++sync_event.invalid_signals >= DIMMER_OUT_OF_SYNC_LIMIT) {
+                Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareAB>();
+                end();
+                // store counter and send event. dimmer needs to be reset to continue safely
+                queues.scheduled_calls.sync_event = true;
+                return;
+            }
 
             #if DEBUG_ZC_PREDICTION
                 debug_pred.invalid_signals++;
-                debug_pred.times[debug_pred.pos++] = dur;
+                debug_pred.times[debug_pred.pos++] = ticks;
                 if (debug_pred.pos >= kTimeStorage) {
                     debug_pred.pos = 0;
                 }
             #endif
 
-            // return;
-            integrate = false;
+            #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+                // the flywheel starts the half wave
+                return;
+            #endif
+            // invalid signal. the half wave starts with the edge
         }
-        // the signal seems valid, reset counter
-        sync_event.invalid_signals = 0;
     #endif
 
+    _delay_halfwave(latency < delay ? delay - latency : 0);
+}
+
+#if ENABLE_ZC_PREDICTION && DIMMER_ZC_FLYWHEEL_HALFWAVES
+
+    void DimmerBase::zc_flywheel_handler()
+    {
+        // clock cycles since the predicted zero crossing
+        int16_t offset;
+        if (!zc_pll.flywheel(timer2.get_timer(), offset)) {
+            // the ZC signal is missing, the dimmer stops until the next edge
+            return;
+        }
+        #if DEBUG_ZC_PREDICTION
+            debug_pred.pred_signals++;
+        #endif
+        _delay_halfwave(get_zero_crossing_delay(offset));
+    }
+
+#endif
+
+// start the half wave after delay ticks of timer1
+void DimmerBase::_delay_halfwave(uint16_t delay)
+{
     // enable timer for delayed zero crossing
     Timer<1>::int_mask_enable<Timer<1>::kIntMaskCompareB>();
-    OCR1B = register_mem.data.cfg.zero_crossing_delay_ticks;
+    OCR1B = delay;
     // assume that this operation takes at least 6 clock cycles including clearing the compare event
     OCR1B += ((6 + (Timer<1>::prescaler - 1)) / Timer<1>::prescaler);
     OCR1B += TCNT1;
@@ -239,15 +338,6 @@ void DimmerBase::zc_interrupt_handler(uint32_t ticks, bool integrate)
 
     sei();
 
-    #if ENABLE_ZC_PREDICTION
-        if (integrate) {
-            // slowly adjust the ticks in case the clock cycles change due to heat
-            // TODO just a test if it changes over time, compare to halfwave_ticks_timer2
-            constexpr auto kHalfwaveNumber = 1000.0;
-            halfwave_ticks_integral = ((halfwave_ticks_integral * kHalfwaveNumber) + dur) / (kHalfwaveNumber + 1.0);
-        }
-    #endif
-    
     // apply fading with interrupts enabled
     _apply_fading();
 
@@ -260,24 +350,13 @@ void DimmerBase::_start_halfwave()
     // copying the data and checking if the signal is valid has a fixed number of clock cycles and can be 
     // compensated by the zero crossing delay during calibration
 
-    #if ENABLE_ZC_PREDICTION
-        // increase counter for an invalid signal. the counter is reset in the zc crossing handler to avoid any delay here doing more calculations
-        if (++sync_event.invalid_signals >= DIMMER_OUT_OF_SYNC_LIMIT) {
-            Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareAB>();
-            end();
-            // store counter and send event. dimmer needs to be reset to continue safely
-            queues.scheduled_calls.sync_event = true;
-            return;
-        }
-    #endif
-
     #if DEBUG_ZC_PREDICTION
         debug_pred.valid_signals++;
     #endif
 
     // double buffering makes sure that the levels stay the same during a single half cycle even if they are modified between interrupts
     // _apply_fading() and _calculate_channels() is asynchronous
-    memcpy(ordered_channels, ordered_channels_buffer, sizeof(ordered_channels));
+    memcpy(&halfwave_slots, &halfwave_slots_buffer, sizeof(halfwave_slots));
 
     // reset timer for the halfwave
     TCNT1 = 0;
@@ -288,14 +367,12 @@ void DimmerBase::_start_halfwave()
     toggle_state = _config.bits.leading_edge ? DIMMER_MOSFET_OFF_STATE : DIMMER_MOSFET_ON_STATE;
 
     #if DIMMER_MAX_CHANNELS > 1
-        channel_ptr = 0;
+        slot_ptr = 0;
     #endif
 
-    // switch channels on in prioritized order
-    OCR1A = ordered_channels[0].ticks;
-    for(Channel::type i = 0; ordered_channels[i].ticks; i++) {
-        _set_mosfet_gate(ordered_channels[i].channel, toggle_state);
-    }
+    // switch dimmed channels on
+    OCR1A = halfwave_slots.slots[0].ticks;
+    _set_mosfet_gates(halfwave_slots.dimmed, toggle_state);
 
     // now there is some time to run the code before compare a can be triggered (by default ~300 microseconds / DIMMER_MIN_ON_TIME_US)
 
@@ -315,7 +392,7 @@ void DimmerBase::_start_halfwave()
     // disable timer for delayed zero crossing
     Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareB>();
 
-    if (ordered_channels[0].ticks && ordered_channels[0].ticks <= TickTypeMax) { // any channel dimmed?
+    if (halfwave_slots.slots[0].ticks && halfwave_slots.slots[0].ticks <= TickTypeMax) { // any channel dimmed?
         // run compare a interrupt to switch MOSFETs
         Timer<1>::int_mask_enable<Timer<1>::kIntMaskCompareA>();
     }
@@ -329,39 +406,32 @@ void DimmerBase::compare_interrupt()
 {
     #if DIMMER_MAX_CHANNELS == 1
 
-        _set_mosfet_gate(ordered_channels[0].channel, toggle_state);
+        _set_mosfet_gate(0, toggle_state);
         Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareA>();
 
     #else
         // this code needs to run as fast as possible
-        auto channel = &ordered_channels[channel_ptr++];
-        auto next_channel = channel;
-        ++next_channel;
-        for(;;) {
-            _set_mosfet_gate(channel->channel, toggle_state);    // toggle current channel
-
-            if (next_channel->ticks == 0) {
-                // no more channels to change, disable compare a interrupt
-                Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareA>();
-                break;
-            }
-            else if (next_channel->ticks > channel->ticks) {
-                // next channel has a different time slot, re-schedule
-                // extraTicks should be at least 1 tick more than this code takes to run or the interrupt won't be triggered
-                // TODO count clock cycles in disassembled code, 54 is probably too high but should not have any visible effect
-                OCR1A = std::max<uint16_t>(Timer<1>::extraTicks + TCNT1, next_channel->ticks);
-                break;
-            }
-            // next channel that is on
-            channel = next_channel;
-            channel_ptr++;
-            next_channel++;
+        // all channels of the time slot are toggled with one read-modify-write per port
+        auto slot = &halfwave_slots.slots[slot_ptr++];
+        _set_mosfet_gates(slot->mask, toggle_state);
+        ++slot;
+        if (slot->ticks == 0) {
+            // no more channels to change, disable compare a interrupt
+            Timer<1>::int_mask_disable<Timer<1>::kIntMaskCompareA>();
+        }
+        else {
+            // re-schedule for the next time slot
+            // extraTicks should be at least 1 tick more than this code takes to run or the interrupt won't be triggered
+            // TODO count clock cycles in disassembled code, 54 is probably too high but should not have any visible effect
+            OCR1A = std::max<uint16_t>(Timer<1>::extraTicks + TCNT1, slot->ticks);
         }
     #endif
 }
 
 namespace Dimmer {
 
+#if !DIMMER_USE_ADC_INTERRUPT && SERIAL_I2C_BRIDGE
+
     void delay(uint32_t ms) 
     {
         // use delay if interrupts are disabled
@@ -381,63 +451,122 @@ namespace Dimmer {
         }
     }
 
+#endif
+
+    // the list is kept sorted between calls and only a few items change their position
+    // at once, which makes the insertion sort O(n) for most calls
     __attribute_always_inline__
-    inline void bubble_sort(ChannelType channels[], Channel::type count)
+    inline void insertion_sort(ChannelType channels[], Channel::type count)
     {
-        Channel::type i, j;
-        if (count >= 2) {
-            count--;
-            for (i = 0; i < count; i++) {
-                for (j = 0; j < count - i; j++) {
-                    if (channels[j].ticks > channels[j + 1].ticks) {
-                        swap<ChannelType>(channels[j], channels[j + 1]);
-                    }
-                }
+        for (Channel::type i = 1; i < count; i++) {
+            auto item = channels[i];
+            auto j = i;
+            for (; j > 0 && channels[j - 1].ticks > item.ticks; j--) {
+                channels[j] = channels[j - 1];
             }
+            channels[j] = item;
         }
     }
 }
 
 // NOTE: this method is only called in _apply_fading()
 // copy data from register memory to buffers
-// calculate ticks for each channel and sort them
+// calculate ticks for each channel that has been marked dirty and sort them
 // channels that are off or fully on won't be added
 void DimmerBase::_calculate_channels()
 {
+    StateType dirty;
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
         // with cubic interpolation enabled, this method can take quite a while
         if (calculate_channels_locked) {
             return;
         }
+        dirty = dirty_channels;
+        if (!dirty) {
+            return;
+        }
+        dirty_channels = 0;
         calculate_channels_locked = true;
     }
 
-    ChannelType ordered_channels_tmp[Channel::size() + 1];
-    Channel::type count = 0;
-    StateType new_channel_state = 0;
+    TickType ticks[Channel::size()];
+    StateType dimmed_channels = 0;
+    StateType new_channel_state = channel_state & ~dirty;
 
-    // copy levels from register memory
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-        memcpy(levels_buffer, _register_mem.channels.level, sizeof(levels_buffer));
-    }
+    #if DIMMER_HAVE_TICKS_TABLE
+        if (!_is_ticks_table_valid()) {
+            _update_ticks_table();
+        }
+    #endif
 
     DIMMER_CHANNEL_LOOP(i) {
-        auto level = DIMMER_LINEAR_LEVEL(levels_buffer[i], i);
-        if (level >= Level::max) {
-            new_channel_state |= (1 << i);
+        if (dirty & (1 << i)) {
+            // copy level from register memory
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                levels_buffer[i] = _register_mem.channels.level[i];
+            }
+            auto level = DIMMER_LINEAR_LEVEL(levels_buffer[i], i);
+            if (level >= Level::max) {
+                new_channel_state |= (1 << i);
+            }
+            else if (level > Level::off) {
+                new_channel_state |= (1 << i);
+                dimmed_channels |= (1 << i);
+                ticks[i] = _get_ticks(i, level); // this always returns the min, number of ticks
+            }
+        }
+    }
+
+    // update the ticks of the dirty channels in the sorted list and remove channels that are not dimmed anymore
+    bool changed = false;
+    Channel::type count = 0;
+    for(Channel::type n = 0; n < sorted_channels_count; n++) {
+        auto item = sorted_channels[n];
+        StateType mask = (1 << item.channel);
+        if (dirty & mask) {
+            if (!(dimmed_channels & mask)) {
+                changed = true;
+                continue;
+            }
+            dimmed_channels &= ~mask;
+            if (item.ticks != ticks[item.channel]) {
+                item.ticks = ticks[item.channel];
+                changed = true;
+            }
         }
-        else if (level > Level::off) {
-            new_channel_state |= (1 << i);
-            ordered_channels_tmp[count].ticks = _get_ticks(i, level); // this always returns the min, number of ticks
-            ordered_channels_tmp[count].channel = i;
-            count++;
+        sorted_channels[count++] = item;
+    }
+    // append channels that are dimmed now
+    if (dimmed_channels) {
+        DIMMER_CHANNEL_LOOP(i) {
+            if (dimmed_channels & (1 << i)) {
+                sorted_channels[count].channel = i;
+                sorted_channels[count].ticks = ticks[i];
+                count++;
+            }
         }
+        changed = true;
     }
-    ordered_channels_tmp[count] = nullptr; // end marker
+    sorted_channels_count = count;
 
-    #if DIMMER_MAX_CHANNELS > 1
-        bubble_sort(ordered_channels_tmp, count);
-    #endif
+    // group the sorted channels into time slots
+    HalfwaveSlotsType slots;
+    if (changed) {
+        #if DIMMER_MAX_CHANNELS > 1
+            insertion_sort(sorted_channels, count);
+        #endif
+        memset(&slots, 0, sizeof(slots));
+        auto slot = slots.slots;
+        for(Channel::type n = 0; n < count; n++) {
+            auto &item = sorted_channels[n];
+            if (slot->ticks && slot->ticks != item.ticks) {
+                slot++;
+            }
+            slot->ticks = item.ticks;
+            slot->mask[Ports::index[item.channel]] |= dimmer_pins_mask[item.channel];
+            slots.dimmed[Ports::index[item.channel]] |= dimmer_pins_mask[item.channel];
+        }
+    }
 
     // copy double buffer with interrupts disabled
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
@@ -445,7 +574,9 @@ void DimmerBase::_calculate_channels()
             channel_state = new_channel_state;
             queues.scheduled_calls.send_channel_state = true;
         }
-        memcpy(ordered_channels_buffer, ordered_channels_tmp, sizeof(ordered_channels_buffer));
+        if (changed) {
+            memcpy(&halfwave_slots_buffer, &slots, sizeof(halfwave_slots_buffer));
+        }
 
         calculate_channels_locked = false;
     }
@@ -470,45 +601,109 @@ void DimmerBase::set_channel_level(Channel::type channel, Level::type level)
     _D(5, debug_printf("ch=%u level=%u ticks=%u zcd=%u\n", channel, _get_level(channel), _get_ticks(channel, level), _config.zero_crossing_delay_ticks));
 }
 
-void DimmerBase::fade_channel_from_to(Channel::type channel, Level::type from, Level::type to, float time, bool absolute_time)
+#if DIMMER_HAVE_STATE_VERSION
+
+void DimmerBase::set_channel_changed(Channel::type channel)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        channel_versions[channel] = ++state_version;
+    }
+}
+
+uint8_t DimmerBase::get_changed_channels(uint16_t version, uint8_t *buffer, uint8_t maxLength)
+{
+    uint16_t current;
+    uint16_t versions[Channel::size()];
+    Level::type levels[Channel::size()];
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        current = state_version;
+        memcpy(versions, channel_versions, sizeof(versions));
+        memcpy(levels, _register_mem.channels.level, sizeof(levels));
+    }
+
+    // channels with a version newer than version are changed. if version is newer than the current version,
+    // the dimmer has been restarted and all channels are returned
+    uint16_t window = current - version;
+    if (static_cast<int16_t>(window) < 0) {
+        window = ~0;
+    }
+
+    // the versions are unique. add the oldest change until the buffer is full
+    auto &header = *reinterpret_cast<dimmer_changed_channels_t *>(buffer);
+    uint8_t space = (maxLength - sizeof(header)) / sizeof(levels[0]);
+    StateType channels = 0;
+    header.version = current;
+    for(;;) {
+        Channel::type oldest = -1;
+        uint16_t oldestAge = 0;
+        DIMMER_CHANNEL_LOOP(i) {
+            uint16_t age = current - versions[i];
+            if (!(channels & (1 << i)) && age < window && (oldest == -1 || age > oldestAge)) {
+                oldest = i;
+                oldestAge = age;
+            }
+        }
+        if (oldest == -1) {
+            break;
+        }
+        if (space-- == 0) {
+            // the master continues with the last channel that has been added
+            header.version = current - oldestAge - 1;
+            break;
+        }
+        channels |= (1 << oldest);
+    }
+    header.channels = channels;
+
+    uint8_t length = sizeof(header);
+    DIMMER_CHANNEL_LOOP(i) {
+        if (channels & (1 << i)) {
+            memcpy(buffer + length, &levels[i], sizeof(levels[i]));
+            length += sizeof(levels[i]);
+        }
+    }
+    return length;
+}
+
+#endif
+
+void DimmerBase::fade_channel_from_to(Channel::type channel, Level::type from, Level::type to, float time, bool absolute_time, FadeCurveType curve)
+{
+    PreparedFadingType prepared;
+    prepare_fading(channel, from, to, time, absolute_time, curve, prepared);
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        start_fading(channel, prepared);
+    }
+}
+
+void DimmerBase::prepare_fading(Channel::type channel, Level::type from, Level::type to, float time, bool absolute_time, FadeCurveType curve, PreparedFadingType &prepared)
 {
     float diff;
-    auto &fade = fading[channel];
-    #if HAVE_FADE_COMPLETION_EVENT
-        fading_completed[channel] = Level::invalid;
-    #endif
+    auto &fade = prepared.fade;
 
     _D(5, debug_printf("fade_channel_from_to from=%d to=%d time=%f\n", from, to, time));
 
+    // stop fading at current level
+    if (to == Level::freeze) {
+        prepared.action = PreparedFadingType::Action::FREEZE;
+        return;
+    }
+
     // get real level not what is stored in the register memory
     Level::type current_level;
     auto ptr = &levels_buffer[channel];
     ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
         current_level = *ptr;
     }
-    // auto current_level = _get_level(channel);
-
-    // Serial.printf_P(PSTR("+REM=ch=%u,f=%d,t=%d,t=%f,l=%d\n"), channel, from, to, time, current_level);
 
-    // stop fading at current level
-    if (to == Level::freeze) {
-        if (fade.count == 0) {
-            // fading not in progress
-            return;
-        }
-        fade.count = 1;
-        fade.step = 0; // keep current level
-        fade.level = current_level;
-        fade.targetLevel = fade.level;
-        return;
-    }
+    // make sure the level is stored if there is nothing to fade
+    prepared.action = PreparedFadingType::Action::SET_LEVEL;
+    fade.targetLevel = to;
 
     from = from == Level::current ? current_level : _normalize_level(from);
     diff = _normalize_level(to) - from;
     if (diff == 0) {
         _D(5, debug_printf("fade normalized -> from=%d to=%d\n", from, to));
-        // make sure the level is stored
-        set_channel_level(channel, to);
         return;
     }
 
@@ -520,19 +715,62 @@ void DimmerBase::fade_channel_from_to(Channel::type channel, Level::type from, L
     fade.count = register_mem.data.metrics.frequency * time * 2.0;
     if (fade.count == 0) {
         _D(5, debug_printf("count=%u time=%f\n", fade.count, time));
-        // make sure the level is stored
-        set_channel_level(channel, to);
         return;
     }
-    fade.step = diff / static_cast<float>(fade.count);
-    fade.level = from;
-    fade.targetLevel = to;
+    prepared.action = PreparedFadingType::Action::FADE;
+    // |diff| <= Level::max and count > 0, the rounding error after count steps is less than one level
+    fade.step = FadingType::toFixedPoint(static_cast<Level::type>(diff)) / fade.count;
+    fade.level = FadingType::toFixedPoint(from);
+    #if DIMMER_HAVE_FADE_CURVES
+        fade.curve = curve < FadeCurveType::MAX ? curve : FadeCurveType::LINEAR;
+        if (fade.curve != FadeCurveType::LINEAR) {
+            // the last step sets targetLevel, the progress is always below 0x10000
+            fade.fromLevel = from;
+            fade.step = 0x10000L / fade.count;
+            fade.level = 0;
+        }
+    #endif
 
     if (fade.count < 1 || fade.step == 0) { // time too short, force to run fading anyway = basically turns the channel on and sends events
         fade.count = 1;
     }
 
-    _D(5, debug_printf("fading ch=%u from=%d to=%d, step=%f count=%u\n", channel, from, to, fade.step, fade.count));
+    _D(5, debug_printf("fading ch=%u from=%d to=%d, step=%ld count=%u curve=%u\n", channel, from, to, (long)fade.step, fade.count, static_cast<uint8_t>(curve)));
+}
+
+void DimmerBase::start_fading(Channel::type channel, const PreparedFadingType &prepared)
+{
+    if (prepared.action == PreparedFadingType::Action::NONE) {
+        return;
+    }
+    auto &fade = fading[channel];
+    #if HAVE_FADE_COMPLETION_EVENT
+        fading_completed[channel] = Level::invalid;
+    #endif
+
+    switch(prepared.action) {
+        case PreparedFadingType::Action::SET_LEVEL:
+            set_channel_level(channel, prepared.fade.targetLevel);
+            break;
+        case PreparedFadingType::Action::FADE:
+            fade = prepared.fade;
+            break;
+        case PreparedFadingType::Action::FREEZE:
+            if (fade.count == 0) {
+                // fading not in progress
+                break;
+            }
+            fade.count = 1;
+            fade.step = 0; // keep current level
+            fade.targetLevel = levels_buffer[channel];
+            fade.level = FadingType::toFixedPoint(fade.targetLevel);
+            #if DIMMER_HAVE_FADE_CURVES
+                fade.curve = FadeCurveType::LINEAR;
+            #endif
+            break;
+        default:
+            break;
+    }
 }
 
 void DimmerBase::_apply_fading()
@@ -552,7 +790,7 @@ void DimmerBase::_apply_fading()
                 #endif
             } 
             else {
-                _set_level(i, fade.level);
+                _set_level(i, fade.getLevel());
             }
         }
     }
@@ -568,20 +806,73 @@ void DimmerBase::_apply_fading()
     _calculate_channels();
 }
 
-TickType DimmerBase::__get_ticks(Channel::type channel, Level::type level) const
-{
-    auto halfWaveTicks = _get_ticks_per_halfwave();
-    TickType rangeTicks = halfWaveTicks - _config.minimum_on_time_ticks - _config.minimum_off_time_ticks;
-    TickType ticks;
+#if DIMMER_HAVE_TICKS_TABLE
+
+    // the half wave is trimmed with every zero crossing. the table is rebuilt if it drifts more than 5us
+    static constexpr TickType kTicksTableDeadband = Timer<1>::ticksPerMicrosecond * 5;
 
-    if (_config.range_divider == 0) {
-        ticks = (static_cast<TickMultiplierType>(rangeTicks) * level) / Level::max;
+    bool DimmerBase::_is_ticks_table_valid() const
+    {
+        TickType diff = ticks_table.halfwave_ticks > halfwave_ticks ? ticks_table.halfwave_ticks - halfwave_ticks : halfwave_ticks - ticks_table.halfwave_ticks;
+        return 
+            diff <= kTicksTableDeadband && 
+            ticks_table.minimum_on_time_ticks == _config.minimum_on_time_ticks && 
+            ticks_table.minimum_off_time_ticks == _config.minimum_off_time_ticks && 
+            ticks_table.range_begin == _config.range_begin && 
+            ticks_table.range_divider == _config.range_divider;
     }
-    else {
-        ticks = (static_cast<TickMultiplierType>(rangeTicks) * (level + _config.range_begin)) / _config.range_divider;
+
+    // the table stores the ticks without clamping them to the min. on and max. off time
+    // otherwise the segment that contains the end of the range would not be linear
+    void DimmerBase::_update_ticks_table()
+    {
+        ticks_table.halfwave_ticks = halfwave_ticks;
+        ticks_table.minimum_on_time_ticks = _config.minimum_on_time_ticks;
+        ticks_table.minimum_off_time_ticks = _config.minimum_off_time_ticks;
+        ticks_table.range_begin = _config.range_begin;
+        ticks_table.range_divider = _config.range_divider;
+
+        TickType rangeTicks = halfwave_ticks - _config.minimum_on_time_ticks - _config.minimum_off_time_ticks;
+        for(uint16_t i = 0; i < TicksTable::kSize; i++) {
+            TickMultiplierType ticks;
+            if (_config.range_divider == 0) {
+                ticks = (static_cast<TickMultiplierType>(rangeTicks) * (i << TicksTable::kShift)) / Level::max;
+            }
+            else {
+                ticks = (static_cast<TickMultiplierType>(rangeTicks) * ((i << TicksTable::kShift) + _config.range_begin)) / _config.range_divider;
+            }
+            ticks += _config.minimum_on_time_ticks;
+            ticks_table.ticks[i] = std::min<TickMultiplierType>(ticks, TickTypeMax);
+        }
+        _D(5, debug_printf("ticks table hw=%u min=%u max=%u\n", halfwave_ticks, ticks_table.ticks[0], ticks_table.ticks[TicksTable::kSize - 1]));
     }
-    ticks += _config.minimum_on_time_ticks;
 
-    return std::clamp<uint16_t>(ticks, _config.minimum_on_time_ticks, halfWaveTicks - _config.minimum_off_time_ticks);
-}
+    // level must be Level::min - Level::max
+    TickType DimmerBase::__get_ticks(Channel::type channel, Level::type level) const
+    {
+        auto ptr = &ticks_table.ticks[static_cast<uint16_t>(level) >> TicksTable::kShift];
+        TickType ticks = ptr[0] + static_cast<TickType>((static_cast<TickMultiplierType>(ptr[1] - ptr[0]) * (level & TicksTable::kMask)) >> TicksTable::kShift);
+        return std::clamp<uint16_t>(ticks, _config.minimum_on_time_ticks, halfwave_ticks - _config.minimum_off_time_ticks);
+    }
+
+#else
+
+    TickType DimmerBase::__get_ticks(Channel::type channel, Level::type level) const
+    {
+        auto halfWaveTicks = _get_ticks_per_halfwave();
+        TickType rangeTicks = halfWaveTicks - _config.minimum_on_time_ticks - _config.minimum_off_time_ticks;
+        TickType ticks;
+
+        if (_config.range_divider == 0) {
+            ticks = (static_cast<TickMultiplierType>(rangeTicks) * level) / Level::max;
+        }
+        else {
+            ticks = (static_cast<TickMultiplierType>(rangeTicks) * (level + _config.range_begin)) / _config.range_divider;
+        }
+        ticks += _config.minimum_on_time_ticks;
+
+        return std::clamp<uint16_t>(ticks, _config.minimum_on_time_ticks, halfWaveTicks - _config.minimum_off_time_ticks);
+    }
+
+#endif
 
@@ -12,18 +12,37 @@
 #include "dimmer_def.h"
 #include "dimmer_protocol.h"
 #include "dimmer_reg_mem.h"
+#include "fade_curves.h"
+#if DIMMER_HAVE_EVENT_QUEUE
+#    include "event_queue.h"
+#endif
+#if DIMMER_HAVE_EVENT_LOG
+#    include "event_log.h"
+#endif
+#if ENABLE_ZC_PREDICTION
+#    include "zc_pll.h"
+#endif
+#if DIMMER_ZC_FILTER
+#    include "zc_filter.h"
+#endif
 #if HAVE_CHANNELS_INLINE_ASM
 #    include "dimmer_inline_asm.h"
 #endif
 
+#ifndef DIMMER_SFR_ZC_STATE
+#    define DIMMER_SFR_ZC_STATE (*portInputRegister(digitalPinToPort(ZC_SIGNAL_PIN)) & digitalPinToBitMask(ZC_SIGNAL_PIN))
+#endif
+
 void remln(const __FlashStringHelper *str);
 
 extern register_mem_union_t register_mem;
+// the counters stop at 255 and can be read with DIMMER_COMMAND_READ_ERROR_COUNTERS
+extern dimmer_error_counters_t error_counters;
 
 #if not HAVE_CHANNELS_INLINE_ASM
     extern volatile uint8_t *dimmer_pins_addr[::size_of(DIMMER_MOSFET_PINS)];
-    extern uint8_t dimmer_pins_mask[::size_of(DIMMER_MOSFET_PINS)];
 #endif
+extern uint8_t dimmer_pins_mask[::size_of(DIMMER_MOSFET_PINS)];
 
 #if !DIMMER_USE_ADC_INTERRUPT && SERIAL_I2C_BRIDGE
 
@@ -126,6 +145,7 @@ namespace Dimmer {
     #else
         using StateType = uint8_t;
     #endif
+    static constexpr StateType kAllChannelsMask = (1UL << Channel::kSize) - 1;
 
     enum class ModeType {
         TRAILING_EDGE,
@@ -165,6 +185,15 @@ namespace Dimmer {
         TimerBase::clear_flags<kFlagsOverflow>();
     }
 
+    #if DIMMER_ZC_INPUT_CAPTURE
+        static_assert(DIMMER_ZC_INTERRUPT_MODE == RISING || DIMMER_ZC_INTERRUPT_MODE == FALLING, "DIMMER_ZC_INPUT_CAPTURE requires RISING or FALLING");
+
+        static constexpr uint8_t kZCCaptureMode = (DIMMER_ZC_INTERRUPT_MODE == RISING ? Timer<1>::kCaptureRising : Timer<1>::kCaptureFalling) | Timer<1>::kCaptureNoiseCanceler;
+
+        // called by TIMER1_CAPT_vect, replaces attachInterrupt() for the ZC signal
+        extern void (*zc_capture_handler)();
+    #endif
+
     // timer 2 running to prescaler 1 to predict the next zc crossing event
     struct MeasureTimer : Timers::TimerBase<2, 1> {
 
@@ -198,7 +227,7 @@ namespace Dimmer {
     {
         // similar to micros() but more precise depending on the MCU frequency and the timer 2 prescaler (ideally 1)
         auto tmp_overflow = _overflow;
-        auto tmp_counter = TCNT2;
+        uint8_t tmp_counter = TCNT2;
         if (TimerBase::get_flag<kFlagsOverflow>() && tmp_counter < 255) { 
             // we got an overflow during reading TCNT2
             tmp_overflow++;
@@ -240,11 +269,52 @@ namespace Dimmer {
         static constexpr uint16_t kVersion = (kMajor << 10) | (kMinor << 5) | kRevision;
     };
 
+    // fixed point Q16.16 level and step size
+    //
+    // for non-linear curves, level and step are the progress of the fading (0-0xffff) and
+    // the current level is calculated from fromLevel, targetLevel and the curve table
     struct FadingType {
-        float level;
-        float step;
+        using FixedPointType = int32_t;
+        static constexpr uint8_t kFractionalBits = 16;
+
+        FixedPointType level;
+        FixedPointType step;
         uint16_t count;
         Level::type targetLevel;
+        #if DIMMER_HAVE_FADE_CURVES
+            Level::type fromLevel;
+            FadeCurveType curve;
+        #endif
+
+        static constexpr FixedPointType toFixedPoint(Level::type level) {
+            return static_cast<FixedPointType>(level) * (1L << kFractionalBits);
+        }
+
+        Level::type getLevel() const {
+            #if DIMMER_HAVE_FADE_CURVES
+                if (curve != FadeCurveType::LINEAR) {
+                    auto diff = static_cast<int32_t>(targetLevel - fromLevel);
+                    return fromLevel + ((diff * FadeCurve::get(curve, level, diff < 0)) >> FadeCurve::kValueBits);
+                }
+            #endif
+            return level >> kFractionalBits;
+        }
+    };
+
+    static_assert(Level::max < (1L << (31 - FadingType::kFractionalBits)), "FadingType::FixedPointType too small");
+
+    // fading calculated by DimmerBase::prepare_fading() with interrupts enabled
+    struct PreparedFadingType {
+        enum class Action : uint8_t {
+            NONE,
+            // set fade.targetLevel without fading
+            SET_LEVEL,
+            FADE,
+            FREEZE,
+        };
+
+        FadingType fade;
+        Action action;
     };
 
     struct ChannelType {
@@ -258,6 +328,78 @@ namespace Dimmer {
         }
     };
 
+    // ports of the MOSFET pins, derived from DIMMER_MOSFET_PINS at compile time. digitalPinToPort() reads a table
+    // from PROGMEM, the ATmega328P/PB maps pin 0-7 to PORTD, 8-13 to PORTB and 14-19 (A0-A5) to PORTC
+    namespace Ports {
+        constexpr uint8_t kMaxPin = 19;
+
+        constexpr uint8_t port(uint8_t pin) {
+            return pin < 8 ? PD : (pin < 14 ? PB : PC);
+        }
+        constexpr uint8_t mask(uint8_t pin) {
+            return _BV(pin < 8 ? pin : (pin < 14 ? pin - 8 : pin - 14));
+        }
+        // true if any of the MOSFET pins is connected to the port
+        constexpr bool has(uint8_t id) {
+            for(auto pin: Channel::pins) {
+                if (port(pin) == id) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        // position of the port in the masks, ordered PORTB, PORTC, PORTD
+        constexpr uint8_t offset(uint8_t id) {
+            return (id > PB && has(PB)) + (id > PC && has(PC));
+        }
+        constexpr bool isValid() {
+            for(auto pin: Channel::pins) {
+                if (pin > kMaxPin) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        constexpr uint8_t kSize = has(PB) + has(PC) + has(PD);
+
+        extern uint8_t index[Channel::kSize];                                   // offset of the port of each channel
+    }
+
+    static_assert(Ports::isValid(), "DIMMER_MOSFET_PINS must be pin 0-19 (PORTB-PORTD)");
+
+    // channels that are switched at the same time with one read-modify-write per port
+    struct TimeSlotType {
+        TickType ticks;
+        uint8_t mask[Ports::kSize];
+    };
+
+    struct HalfwaveSlotsType {
+        uint8_t dimmed[Ports::kSize];                                           // all dimmed channels
+        TimeSlotType slots[Channel::size() + 1];                                // sorted by ticks, ticks=0 is the end marker
+    };
+
+    #if DIMMER_HAVE_TICKS_TABLE
+
+        // piecewise linear table to convert levels into ticks
+        struct TicksTable {
+            static constexpr uint8_t kShift = DIMMER_TICKS_TABLE_SHIFT;
+            static constexpr uint16_t kMask = (1 << kShift) - 1;
+            static constexpr uint16_t kSize = (Level::max >> kShift) + 2;
+
+            TickType ticks[kSize];
+            // settings the table has been created for
+            TickType halfwave_ticks;
+            uint16_t minimum_on_time_ticks;
+            uint16_t minimum_off_time_ticks;
+            uint16_t range_begin;
+            uint16_t range_divider;
+
+            static_assert(kShift >= 1 && kShift <= 8, "DIMMER_TICKS_TABLE_SHIFT out of range");
+        };
+
+    #endif
+
     struct __attribute_packed__ FadingCompletionEvent : dimmer_fading_complete_event_t {
 
         using dimmer_fading_complete_event_t::dimmer_fading_complete_event_t;
@@ -274,33 +416,40 @@ namespace Dimmer {
         Level::type levels_buffer[Channel::size()];                             // single buffer for levels since they are used only when the halfwave starts
         FadingType fading[Channel::size()];                                  // calculated fading data
         #if DIMMER_MAX_CHANNELS > 1
-            Channel::type channel_ptr;                                          // internal pointer used between interrupts
+            Channel::type slot_ptr;                                             // internal pointer used between interrupts
         #endif
         // for double bufferring. the calculation is done on the stack and copied into the first buffer
         // before the half wave starts the first buffer is copied into the second buffer, which is used inside the interrupts
-        ChannelType ordered_channels[Channel::size() + 1];                 // current dimming levels in ticks, second buffer
-        ChannelType ordered_channels_buffer[Channel::size() + 1];          // next dimming levels, first buffer
+        HalfwaveSlotsType halfwave_slots;                                       // current time slots, second buffer
+        HalfwaveSlotsType halfwave_slots_buffer;                                // next time slots, first buffer
+        ChannelType sorted_channels[Channel::size()];                      // channels sorted by ticks, kept between calls of _calculate_channels()
+        Channel::type sorted_channels_count;
         TickType halfwave_ticks;
+        uint32_t halfwave_cycles;                                               // length of the half wave from the frequency measurement, clock cycles with 8 bit fraction
         StateType channel_state;                                                // bitset of the channel state
+        volatile StateType dirty_channels;                                      // bitset of the channels that need to be updated by _calculate_channels()
+        #if DIMMER_HAVE_TICKS_TABLE
+            TicksTable ticks_table;
+        #endif
         volatile bool toggle_state;                                             // next state of the mosfets
         volatile bool calculate_channels_locked;
 
         #if ENABLE_ZC_PREDICTION
-            // avg, min and max. clock cycles
-            uint24_t halfwave_ticks_timer2;
-            uint24_t halfwave_ticks_min;
-            uint24_t halfwave_ticks_max;
-            // last value to calculate difference
-            uint32_t last_ticks;
-            // keeps track of frequency changes to adjust the timer (use method DimmerBase:.set_halfwave_ticks() to update all values)
-            // the value should be equal to halfwave_ticks_timer2 but might suffer from temperature drift (or changes in the mains frequency)
-            float halfwave_ticks_integral;
+            // tracks the phase and the length of the half wave
+            ZeroCrossingPll zc_pll;
             // 
             dimmer_sync_event_t sync_event;
         #endif
+        #if DIMMER_ZC_FILTER
+            ZeroCrossingFilter zc_filter;
+        #endif
         #if HAVE_FADE_COMPLETION_EVENT
             Level::type fading_completed[Channel::size()];
         #endif
+        #if DIMMER_HAVE_STATE_VERSION
+            uint16_t state_version;                                             // incremented for each change of the levels
+            uint16_t channel_versions[Channel::size()];                         // state_version of the last change of each channel
+        #endif
     };
 
     class DimmerBase : public dimmer_t {
@@ -310,19 +459,53 @@ namespace Dimmer {
             _config(register_mem.cfg),
             _register_mem(register_mem)
         {
+            #if DIMMER_HAVE_STATE_VERSION
+                // get_changed_channels() requires a unique version for each channel
+                DIMMER_CHANNEL_LOOP(i) {
+                    channel_versions[i] = ++state_version;
+                }
+            #endif
         }
 
         void begin();
         void end();
-        void zc_interrupt_handler(uint32_t ticks, bool integrate);
+        // latency      timer1 ticks since the edge (DIMMER_ZC_INPUT_CAPTURE)
+        void zc_interrupt_handler(uint32_t ticks, uint16_t latency);
+        #if ENABLE_ZC_PREDICTION && DIMMER_ZC_FLYWHEEL_HALFWAVES
+            // TIMER2_OVF_vect, starts the half wave from the prediction if the edge is missing
+            void zc_flywheel_handler();
+        #endif
         #if ENABLE_ZC_PREDICTION
-            bool is_ticks_within_range(uint24_t ticks);
-            void set_halfwave_ticks(uint24_t ticks);
+            // update the frequency and sync_event from the length of the half wave tracked by the PLL
+            void update_frequency();
         #endif
 
         void set_frequency(float freq);
+        // set the length of the half wave from the frequency measurement in clock cycles with 8 bit fraction, 0 if it has failed
+        void set_halfwave(uint32_t cycles);
         void set_mode(ModeType mode);
 
+        // Recalculate the ticks of the channels in the next call of _calculate_channels()
+        // changes of the configuration or the frequency must update all channels
+        //
+        // channels         bitset of the channels
+        void set_channels_dirty(StateType channels = kAllChannelsMask);
+
+        #if DIMMER_HAVE_STATE_VERSION
+            // Increment the state version and assign it to the channel
+            //
+            // channel          Channel::min - Channel::max
+            void set_channel_changed(Channel::type channel);
+
+            // Write dimmer_changed_channels_t and the levels of the channels changed after version into buffer
+            // if not all channels fit into maxLength, the oldest changes are returned first
+            //
+            // version          version returned by the last call. a version newer than the current version
+            //                  returns all channels
+            // returns the length
+            uint8_t get_changed_channels(uint16_t version, uint8_t *buffer, uint8_t maxLength);
+        #endif
+
         // Set channel to level
         //
         // channel          Channel::min - Channel::max
@@ -343,7 +526,8 @@ namespace Dimmer {
         // to_level         Level::min - Level::max
         // time             time for fading from Level::min to Level::max in seconds
         //                  if absolute_time is set to true, the time is from_level to to_level
-        void fade_channel_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time = false);
+        // curve            FadeCurveType::LINEAR or a non-linear curve, ignored if DIMMER_HAVE_FADE_CURVES is 0
+        void fade_channel_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time = false, FadeCurveType curve = FadeCurveType::LINEAR);
 
         // Change level from current level to "to_level" within "time"
         //
@@ -359,7 +543,18 @@ namespace Dimmer {
         // to_level         Level::min - Level::max
         // time             time for fading from Level::min to Level::max in seconds
         //                  if absolute_time is set to true, the time is from_level to to_level
-        void fade_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time = false);
+        // curve            FadeCurveType::LINEAR or a non-linear curve, ignored if DIMMER_HAVE_FADE_CURVES is 0
+        void fade_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time = false, FadeCurveType curve = FadeCurveType::LINEAR);
+
+        // Calculate the fading of fade_channel_from_to() without changing the channel. the float math runs with
+        // interrupts enabled and start_fading() starts several channels in the same half wave
+        //
+        // prepared         the result, PreparedFadingType::Action::NONE is not changed by start_fading()
+        void prepare_fading(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time, FadeCurveType curve, PreparedFadingType &prepared);
+
+        // Start the fading calculated by prepare_fading()
+        // interrupts must be disabled to start several channels in the same half wave
+        void start_fading(Channel::type channel, const PreparedFadingType &prepared);
 
         //
         // send fading completion events for all channels
@@ -374,6 +569,10 @@ namespace Dimmer {
 
         TickType _get_ticks_per_halfwave() const;
         TickType __get_ticks(Channel::type channel, Level::type level) const;
+        #if DIMMER_HAVE_TICKS_TABLE
+            bool _is_ticks_table_valid() const;
+            void _update_ticks_table();
+        #endif
         TickType _get_ticks(Channel::type channel, Level::type level);
         uint16_t _get_level(Channel::type channel) const;
         void _set_level(Channel::type channel, Level::type level);
@@ -384,7 +583,7 @@ namespace Dimmer {
         void _timer_setup();
         void _timer_remove();
         void _start_halfwave();
-        void _delay_halfwave();
+        void _delay_halfwave(uint16_t delay);
         float _get_frequency() const;
 
         #if HAVE_CHANNELS_INLINE_ASM
@@ -421,6 +620,37 @@ namespace Dimmer {
             }
         #endif
 
+        // mask       bits for each port of the channels to switch, see Ports
+        //
+        // the port registers are constant and each port is switched with in/or/out or in/and/out. the unused
+        // ports are removed at compile time
+        inline void _set_mosfet_gates(const uint8_t *mask, bool state) {
+            if (state) {
+                _set_port_bits<PB>(PORTB, mask);
+                _set_port_bits<PC>(PORTC, mask);
+                _set_port_bits<PD>(PORTD, mask);
+            }
+            else {
+                _clear_port_bits<PB>(PORTB, mask);
+                _clear_port_bits<PC>(PORTC, mask);
+                _clear_port_bits<PD>(PORTD, mask);
+            }
+        }
+
+        template<uint8_t _Port>
+        static inline void _set_port_bits(volatile uint8_t &reg, const uint8_t *mask) {
+            if constexpr (Ports::has(_Port)) {
+                reg |= mask[Ports::offset(_Port)];
+            }
+        }
+
+        template<uint8_t _Port>
+        static inline void _clear_port_bits(volatile uint8_t &reg, const uint8_t *mask) {
+            if constexpr (Ports::has(_Port)) {
+                reg &= ~mask[Ports::offset(_Port)];
+            }
+        }
+
         void _calculate_channels();
         static void _calc_halfwave_min_max(uint24_t ticks, uint24_t &hMin, uint24_t &hMax);
 
@@ -448,9 +678,23 @@ namespace Dimmer {
         register_mem.data.metrics.frequency = freq;
     }
 
+    inline void DimmerBase::set_halfwave(uint32_t cycles) 
+    {
+        halfwave_cycles = cycles;
+        set_frequency(cycles ? ((F_CPU / 2.0) * (1 << 8)) / cycles : NAN);
+    }
+
     inline void DimmerBase::set_mode(ModeType mode) 
     {
         _config.bits.leading_edge = (mode == ModeType::LEADING_EDGE);
+        set_channels_dirty();
+    }
+
+    inline void DimmerBase::set_channels_dirty(StateType channels)
+    {
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+            dirty_channels |= channels;
+        }
     }
 
     inline void DimmerBase::fade_channel_to(Channel::type channel, Level::type to_level, float time) 
@@ -477,7 +721,16 @@ namespace Dimmer {
 
     inline void DimmerBase::_set_level(Channel::type channel, Level::type level) 
     {
-        _register_mem.channels.level[channel] = level;
+        #if DIMMER_HAVE_STATE_VERSION
+            if (_register_mem.channels.level[channel] != level) {
+                // the version is changed after the level. the I2C command handler can interrupt this method
+                _register_mem.channels.level[channel] = level;
+                set_channel_changed(channel);
+            }
+        #else
+            _register_mem.channels.level[channel] = level;
+        #endif
+        set_channels_dirty(1 << channel);
     }
 
     inline Level::type DimmerBase::_normalize_level(Level::type level) const 
@@ -491,15 +744,6 @@ namespace Dimmer {
         return register_mem.data.metrics.frequency;
     }
 
-    #if ENABLE_ZC_PREDICTION
-        inline bool DimmerBase::is_ticks_within_range(uint24_t ticks) 
-        {
-            // check if ticks is within the range
-            // ticks is the clock cycles since the last
-            return (ticks >= halfwave_ticks_min && ticks <= halfwave_ticks_max);
-        }
-    #endif
-
     inline void DimmerBase::set_level(Channel::type channel, Level::type level)
     {
         // _D(5, debug_printf("set_level ch=%d level=%d\n", channel, level))
@@ -516,56 +760,46 @@ namespace Dimmer {
         }
     }
 
-    inline void DimmerBase::fade_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time)
+    inline void DimmerBase::fade_from_to(Channel::type channel, Level::type from_level, Level::type to_level, float time, bool absolute_time, FadeCurveType curve)
     {
         _D(5, debug_printf("fade_from_to ch=%d from=%d to=%d time=%f\n", channel, from_level, to_level, time))
         #if DIMMER_HAVE_SET_ALL_CHANNELS_AT_ONCE
             if (channel == Channel::any) {
                 DIMMER_CHANNEL_LOOP(i) {
-                    fade_channel_from_to(i, from_level, to_level, time, absolute_time);
+                    fade_channel_from_to(i, from_level, to_level, time, absolute_time, curve);
                 }
             }
             else 
         #endif
         {
-            fade_channel_from_to(channel, from_level, to_level, time, absolute_time);
+            fade_channel_from_to(channel, from_level, to_level, time, absolute_time, curve);
         }
     }
 
 
+    // send an event to DIMMER_I2C_MASTER_ADDRESS. extraByte is sent before the data if not nullptr
+    void send_event(uint8_t event, const uint8_t *extraByte, const uint8_t *data, uint8_t length);
+
     // i2c response template
     template<uint8_t _Event>
     struct DimmerEvent {
 
-        inline static void _send(const uint8_t *buffer, uint8_t length)
-        {
-            Wire.write(buffer, length);
-            Wire.endTransmission();
-        }
-
         template<typename _Type>
         static void send(const _Type &data, uint8_t length)
         {
-            Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
-            Wire.write(_Event);
-            _send(reinterpret_cast<const uint8_t *>(&data), length);
+            send_event(_Event, nullptr, reinterpret_cast<const uint8_t *>(&data), length);
         }
 
         template<typename _Type>
         static void send(const _Type &data)
         {
-            Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
-            Wire.write(_Event);
-            _send(reinterpret_cast<const uint8_t *>(&data), static_cast<uint8_t>(sizeof(data)));
+            send_event(_Event, nullptr, reinterpret_cast<const uint8_t *>(&data), static_cast<uint8_t>(sizeof(data)));
         }
 
         template<typename _Type>
         static void send(const uint8_t extraByte, const _Type &data)
         {
-            Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
-            Wire.write(_Event);
-            Wire.write(extraByte);
-            _send(reinterpret_cast<const uint8_t *>(&data), static_cast<uint8_t>(sizeof(data)));
+            send_event(_Event, &extraByte, reinterpret_cast<const uint8_t *>(&data), static_cast<uint8_t>(sizeof(data)));
         }
     };
 
@@ -14,6 +14,11 @@
 #    define DEBUG 0
 #endif
 
+// build for the host with the hardware layer and simulator from ./sim (env:native)
+#ifndef DIMMER_NATIVE
+#    define DIMMER_NATIVE 0
+#endif
+
 // enable debug code
 #ifndef DEBUG_FREQUENCY_MEASUREMENT
 #    define DEBUG_FREQUENCY_MEASUREMENT 0
@@ -27,11 +32,35 @@
 
 // enable zero crossing prediction and error correction. requires re-calibration of the zero crossing since the 
 // clock cycles change if enabled
-// TODO unstable at the moment
+// the zero crossing is tracked with a digital PLL, see zc_pll.h
 #ifndef ENABLE_ZC_PREDICTION
 #    define ENABLE_ZC_PREDICTION 0
 #endif
 
+// the phase error of each edge corrects the phase by 1 / 2^DIMMER_ZC_PLL_PHASE_SHIFT and the length of the
+// half wave by 1 / 2^DIMMER_ZC_PLL_FREQUENCY_SHIFT. higher values filter more jitter but track changes of the
+// mains frequency slower. for a critically damped PLL, FREQUENCY_SHIFT is 2 * PHASE_SHIFT + 2
+#ifndef DIMMER_ZC_PLL_PHASE_SHIFT
+#    define DIMMER_ZC_PLL_PHASE_SHIFT 3
+#endif
+
+#ifndef DIMMER_ZC_PLL_FREQUENCY_SHIFT
+#    define DIMMER_ZC_PLL_FREQUENCY_SHIFT 8
+#endif
+
+// max. average phase error in microseconds to report the PLL as locked
+#ifndef DIMMER_ZC_PLL_LOCK_THRESHOLD_US
+#    define DIMMER_ZC_PLL_LOCK_THRESHOLD_US 10
+#endif
+
+// start up to DIMMER_ZC_FLYWHEEL_HALFWAVES half waves from the prediction of the PLL if the ZC signal is missing
+// or has been rejected. 0 disables the flywheel and rejected edges start the half wave
+#ifndef DIMMER_ZC_FLYWHEEL_HALFWAVES
+#    define DIMMER_ZC_FLYWHEEL_HALFWAVES 8
+#endif
+
+static_assert(DIMMER_ZC_FLYWHEEL_HALFWAVES < 256, "DIMMER_ZC_FLYWHEEL_HALFWAVES too high");
+
 // enable serial debug output
 #ifndef DEBUG_ZC_PREDICTION
 #    define DEBUG_ZC_PREDICTION 0
@@ -60,6 +89,47 @@
 // #    define DIMMER_ZC_INTERRUPT_MODE FALLING
 #endif
 
+// use the input capture unit of timer 1 for the zero crossing signal instead of an external interrupt. the edge is
+// timestamped by the hardware and the latency of the interrupt is removed from the zero crossing delay and the PLL
+// (ENABLE_ZC_PREDICTION). the signal must be connected to ICP1 (PB0, ZC_SIGNAL_PIN=8) and DIMMER_ZC_INTERRUPT_MODE
+// must be RISING or FALLING
+#ifndef DIMMER_ZC_INPUT_CAPTURE
+#    define DIMMER_ZC_INPUT_CAPTURE 0
+#endif
+
+#if DIMMER_ZC_INPUT_CAPTURE && !DIMMER_HEADERS_ONLY && ZC_SIGNAL_PIN != 8
+#    error DIMMER_ZC_INPUT_CAPTURE requires ZC_SIGNAL_PIN=8 (ICP1)
+#endif
+
+// filter spurious edges of the zero crossing signal before they start the half wave or reach the PLL. rejected edges
+// are counted per cause in error_counters (dimmer_error_counters_t), which can be read with DIMMER_COMMAND_READ_ERROR_COUNTERS
+#ifndef DIMMER_ZC_FILTER
+#    define DIMMER_ZC_FILTER 0
+#endif
+
+// edges within DIMMER_ZC_FILTER_BLANKING_US after the last valid edge are ignored
+#ifndef DIMMER_ZC_FILTER_BLANKING_US
+#    define DIMMER_ZC_FILTER_BLANKING_US 4000
+#endif
+
+// the ZC signal must be active for DIMMER_ZC_FILTER_MIN_PULSE_US after the edge. the interrupt waits until the time has
+// passed. 0 disables the check
+#ifndef DIMMER_ZC_FILTER_MIN_PULSE_US
+#    define DIMMER_ZC_FILTER_MIN_PULSE_US 10
+#endif
+
+// the interval to the last valid edge must match the length of the half wave (DIMMER_ZC_INTERVAL_MAX_DEVIATION) and
+// DIMMER_ZC_FILTER_VALID_EDGES of the last DIMMER_ZC_FILTER_EDGES edges must be valid (N-of-M). 0 disables the check
+#ifndef DIMMER_ZC_FILTER_VALID_EDGES
+#    define DIMMER_ZC_FILTER_VALID_EDGES 3
+#endif
+
+#ifndef DIMMER_ZC_FILTER_EDGES
+#    define DIMMER_ZC_FILTER_EDGES 4
+#endif
+
+static_assert(DIMMER_ZC_FILTER_EDGES <= 8 && DIMMER_ZC_FILTER_VALID_EDGES <= DIMMER_ZC_FILTER_EDGES, "check DIMMER_ZC_FILTER_EDGES");
+
 // DIMMER_MIN_ON_TIME_US and DIMMER_MIN_OFF_TIME_US remove the unusable part of the halfwave
 // to maximize the level range. the level range can be configured dynamically to match the
 // requirements of the device being dimmed
@@ -109,7 +179,7 @@ static_assert(DIMMER_MIN_OFF_TIME_US > 200, "DIMMER_MIN_OFF_TIME_US too low");
 
 static_assert(DIMMER_OUT_OF_SYNC_LIMIT > 16, "DIMMER_OUT_OF_SYNC_LIMIT too low");
 
-// min. number of samples to collect, should be more than 100. it requires 3 byte dynamic memory per sample and is released after the measurement is done
+// max. number of samples to collect if the measurement does not lock before, should be more than 100
 #ifndef DIMMER_ZC_MIN_SAMPLES
 #    define DIMMER_ZC_MIN_SAMPLES 128
 #endif
@@ -123,6 +193,19 @@ static_assert(DIMMER_OUT_OF_SYNC_LIMIT > 16, "DIMMER_OUT_OF_SYNC_LIMIT too low")
 static constexpr auto kValidSamplesPercent = DIMMER_ZC_MIN_VALID_SAMPLES * 100.0 / DIMMER_ZC_MIN_SAMPLES;
 static_assert(kValidSamplesPercent >= 50 && kValidSamplesPercent <= 80, "read comment for DIMMER_ZC_MIN_VALID_SAMPLES");
 
+// the frequency measurement locks early if it has at least DIMMER_ZC_LOCK_MIN_SAMPLES valid samples, the same ratio
+// of valid samples as DIMMER_ZC_MIN_VALID_SAMPLES and the standard error of the mean length of the half wave is below
+// DIMMER_ZC_LOCK_MAX_ERROR_US. a clean signal locks after ~0.3 seconds. 0 disables the early lock
+#ifndef DIMMER_ZC_LOCK_MIN_SAMPLES
+#    define DIMMER_ZC_LOCK_MIN_SAMPLES 24
+#endif
+
+#ifndef DIMMER_ZC_LOCK_MAX_ERROR_US
+#    define DIMMER_ZC_LOCK_MAX_ERROR_US 2
+#endif
+
+static_assert(DIMMER_ZC_LOCK_MIN_SAMPLES == 0 || (DIMMER_ZC_LOCK_MIN_SAMPLES >= 16 && DIMMER_ZC_LOCK_MIN_SAMPLES < DIMMER_ZC_MIN_SAMPLES), "DIMMER_ZC_LOCK_MIN_SAMPLES out of range");
+
 // max. deviation per half cycle 
 // if the deviation is too low too low, it filters too many events leading to flickering. too high **might** lead to visible flickering
 // the maximum i measured was +-0.0718% with regular mains voltage and no filter, but the MCU might be stuck with interrupts disabled etc... 0.2% seem to be 
@@ -166,6 +249,7 @@ static_assert(kDeviationPercent >= 0.25 && kDeviationPercent <= 3, "read comment
 
 // output pins as comma separated list
 // channels will be address from 0 to max.
+// pin 0-19 (PORTB-PORTD), the port registers are resolved at compile time
 #ifndef DIMMER_MOSFET_PINS
 #    define DIMMER_MOSFET_PINS 6, 8, 9, 10
 #endif
@@ -210,6 +294,39 @@ static_assert(kDeviationPercent >= 0.25 && kDeviationPercent <= 3, "read comment
 #    define DIMMER_TIMER1_PRESCALER 8
 #endif
 
+// optional byte after DIMMER_COMMAND_FADE to select a non-linear curve (DIMMER_FADE_CURVE_*)
+#ifndef DIMMER_HAVE_FADE_CURVES
+#    define DIMMER_HAVE_FADE_CURVES 1
+#endif
+
+// DIMMER_COMMAND_SET_GROUP_LEVELS changes the channels of several boards with a single transaction to the
+// general call address. the group and the offset of the first channel inside the group are stored in the EEPROM
+// requires DIMMER_HAVE_TWI_SLAVE or DIMMER_SERIAL_BINARY_FRAMES, which report the general call to the receive handler
+#ifndef DIMMER_HAVE_GROUPS
+#    define DIMMER_HAVE_GROUPS 0
+#endif
+
+// default group after restoring the factory settings
+#ifndef DIMMER_GROUP_ID
+#    define DIMMER_GROUP_ID DIMMER_GROUP_NONE
+#endif
+
+// default offset of channel 0 inside the group
+#ifndef DIMMER_GROUP_CHANNEL_OFFSET
+#    define DIMMER_GROUP_CHANNEL_OFFSET 0
+#endif
+
+// scenes with a level and fading time for each channel stored in the EEPROM
+// DIMMER_COMMAND_RECALL_SCENE starts all channels in the same half wave
+#ifndef DIMMER_HAVE_SCENES
+#    define DIMMER_HAVE_SCENES 0
+#endif
+
+// number of scenes, each scene uses 4 byte per channel in the EEPROM
+#ifndef DIMMER_SCENE_COUNT
+#    define DIMMER_SCENE_COUNT 4
+#endif
+
 // sent event when fading has reached the target level
 #ifndef HAVE_FADE_COMPLETION_EVENT
 #    define HAVE_FADE_COMPLETION_EVENT 1
@@ -248,6 +365,91 @@ static_assert(kDeviationPercent >= 0.25 && kDeviationPercent <= 3, "read comment
 #    define SERIAL_I2C_BRIDGE 0
 #endif
 
+// replace the Wire library with the TWI slave driver in twi_slave.cpp, which sends register reads without
+// copying them. the Wire library must be excluded from the build (lib_ignore = Wire)
+#ifndef DIMMER_HAVE_TWI_SLAVE
+#    define DIMMER_HAVE_TWI_SLAVE 0
+#endif
+
+// replace the text protocol of the serial bridge (+I2CT=...) with binary frames, see serial_frames.h. requires
+// SERIAL_I2C_BRIDGE and the i2c_uart_bridge library must be removed from lib_deps
+#ifndef DIMMER_SERIAL_BINARY_FRAMES
+#    define DIMMER_SERIAL_BINARY_FRAMES 0
+#endif
+
+// send events from a queue in loop() instead of blocking inside DimmerEvent::send(). with DIMMER_HAVE_TWI_SLAVE,
+// the events are transmitted by the TWI interrupt. see event_queue.h
+#ifndef DIMMER_HAVE_EVENT_QUEUE
+#    define DIMMER_HAVE_EVENT_QUEUE 0
+#endif
+
+// number of events in the queue. a metrics report with HAVE_ISR_STATS_EVENT adds up to 6 events at once
+#ifndef DIMMER_EVENT_QUEUE_SIZE
+#    define DIMMER_EVENT_QUEUE_SIZE 6
+#endif
+
+// max. size of an event including the event id, longer events are truncated like by the Wire library
+#ifndef DIMMER_EVENT_QUEUE_DATA_SIZE
+#    define DIMMER_EVENT_QUEUE_DATA_SIZE 32
+#endif
+
+// number of retries if the master does not acknowledge the event
+#ifndef DIMMER_EVENT_QUEUE_RETRIES
+#    define DIMMER_EVENT_QUEUE_RETRIES 3
+#endif
+
+// delay before the first retry in milliseconds, doubled for each following retry
+#ifndef DIMMER_EVENT_QUEUE_BACKOFF_MILLIS
+#    define DIMMER_EVENT_QUEUE_BACKOFF_MILLIS 25
+#endif
+
+// send queued events that fit into DIMMER_EVENT_QUEUE_DATA_SIZE as one DIMMER_EVENT_COMPOUND. requires
+// DIMMER_HAVE_EVENT_QUEUE
+#ifndef DIMMER_HAVE_COMPOUND_EVENTS
+#    define DIMMER_HAVE_COMPOUND_EVENTS 0
+#endif
+
+#if DIMMER_HAVE_COMPOUND_EVENTS && !DIMMER_HAVE_EVENT_QUEUE
+#    error DIMMER_HAVE_COMPOUND_EVENTS requires DIMMER_HAVE_EVENT_QUEUE
+#endif
+
+#if DIMMER_HAVE_GROUPS && (SERIAL_I2C_BRIDGE ? !DIMMER_SERIAL_BINARY_FRAMES : !DIMMER_HAVE_TWI_SLAVE)
+#    error DIMMER_HAVE_GROUPS requires DIMMER_HAVE_TWI_SLAVE or DIMMER_SERIAL_BINARY_FRAMES
+#endif
+
+// time in milliseconds to wait for more events after an event has been added to the empty queue. the
+// channel state is sent ~100ms before the fading completed event
+#ifndef DIMMER_COMPOUND_EVENTS_DELAY_MILLIS
+#    define DIMMER_COMPOUND_EVENTS_DELAY_MILLIS 10
+#endif
+
+// add a 16 bit sequence number after the event id and keep the last events in SRAM, which can be read with
+// DIMMER_COMMAND_READ_EVENT_LOG. see event_log.h
+#ifndef DIMMER_HAVE_EVENT_LOG
+#    define DIMMER_HAVE_EVENT_LOG 0
+#endif
+
+// size of the log in byte, power of 2 up to 128
+#ifndef DIMMER_EVENT_LOG_SIZE
+#    define DIMMER_EVENT_LOG_SIZE 128
+#endif
+
+// max. size of the response to DIMMER_COMMAND_READ_EVENT_LOG, the buffer size of the I2C driver
+#ifndef DIMMER_EVENT_LOG_READ_SIZE
+#    define DIMMER_EVENT_LOG_READ_SIZE 32
+#endif
+
+// count changes of the channel levels and return the channels that changed since a version with
+// DIMMER_COMMAND_READ_CHANGED_CHANNELS
+#ifndef DIMMER_HAVE_STATE_VERSION
+#    define DIMMER_HAVE_STATE_VERSION 0
+#endif
+
+// max. size of the response to DIMMER_COMMAND_READ_CHANGED_CHANNELS, the buffer size of the I2C driver
+#ifndef DIMMER_CHANGED_CHANNELS_READ_SIZE
+#    define DIMMER_CHANGED_CHANNELS_READ_SIZE 32
+#endif
+
 #ifndef DEFAULT_BAUD_RATE
 #    define DEFAULT_BAUD_RATE 57600
 #endif
@@ -366,6 +568,22 @@ static constexpr auto kDimmerCheckIntervalCycles = microsecondsToClockCycles(DIM
 #    define HAVE_PRINT_METRICS 0
 #endif
 
+// measure duration and latency of the compare A/B, zero crossing and ADC interrupt handlers with timer2
+// the statistics can be read with DIMMER_COMMAND_READ_ISR_STATS
+// ~140 byte SRAM
+#ifndef HAVE_ISR_STATS
+#    define HAVE_ISR_STATS 0
+#endif
+
+// send DIMMER_EVENT_ISR_STATS for each handler with the metrics report
+#ifndef HAVE_ISR_STATS_EVENT
+#    define HAVE_ISR_STATS_EVENT 0
+#endif
+
+#if HAVE_ISR_STATS_EVENT && !HAVE_ISR_STATS
+#    error HAVE_ISR_STATS_EVENT requires HAVE_ISR_STATS
+#endif
+
 #ifndef EEPROM_WRITE_DELAY
 #    define EEPROM_WRITE_DELAY 500
 #endif
@@ -384,6 +602,23 @@ static constexpr auto kDimmerCheckIntervalCycles = microsecondsToClockCycles(DIM
 #    define DIMMER_USE_QUEUE_LEVELS 0
 #endif
 
+// number of commands in the queue, power of 2. one entry is kept free
+#ifndef DIMMER_LEVEL_QUEUE_SIZE
+#    define DIMMER_LEVEL_QUEUE_SIZE 8
+#endif
+
+// convert levels into ticks with a piecewise linear table instead of a 32 bit multiplication and division for each channel
+// the table is rebuilt if the half wave length, minimum on/off time or the range changes. the error is 1 tick max.
+// (DIMMER_MAX_LEVEL >> DIMMER_TICKS_TABLE_SHIFT) + 2 entries are stored in SRAM, 68 byte for 8192 levels
+#ifndef DIMMER_HAVE_TICKS_TABLE
+#    define DIMMER_HAVE_TICKS_TABLE 0
+#endif
+
+// number of levels per segment (1 << DIMMER_TICKS_TABLE_SHIFT), 1-8
+#ifndef DIMMER_TICKS_TABLE_SHIFT
+#    define DIMMER_TICKS_TABLE_SHIFT 8
+#endif
+
 #if DIMMER_CUBIC_INTERPOLATION
 #    define DIMMER_LINEAR_LEVEL(level, channel) (register_mem.data.cfg.bits.cubic_interpolation ? cubicInterpolation.getLevel(level, channel) : level)
 #    if DIMMER_CUBIC_INTERPOLATION
@@ -410,6 +645,13 @@ static constexpr auto kDimmerCheckIntervalCycles = microsecondsToClockCycles(DIM
 #   error DIMMER_CUBIC_INT_DATA_POINTS is limited to 8
 #endif
 
+// the spline of each channel is stored in a piecewise linear table with (DIMMER_MAX_LEVEL >> DIMMER_CUBIC_INT_TABLE_SHIFT) + 2 entries
+// it is created when the data points are changed. 68 byte per channel with data points for 8192 levels
+// number of levels per segment (1 << DIMMER_CUBIC_INT_TABLE_SHIFT), 1-8
+#ifndef DIMMER_CUBIC_INT_TABLE_SHIFT
+#   define DIMMER_CUBIC_INT_TABLE_SHIFT 8
+#endif
+
 #ifndef DIMMER_VERSION_MAJOR
 #    error version not defined
 #endif
@@ -75,11 +75,23 @@
 #define DIMMER_EVENT_CHANNEL_ON_OFF         0xf5
 #define DIMMER_EVENT_SYNC_EVENT             0xf6
 #define DIMMER_EVENT_RESTART                0xf7
+#define DIMMER_EVENT_ISR_STATS              0xf8
+// several events in one transaction (DIMMER_HAVE_COMPOUND_EVENTS), each event is the length of the event
+// id and payload, followed by the event id and payload
+#define DIMMER_EVENT_COMPOUND               0xf9
 //
 // DIMMER_REGISTER_COMMAND
 #define DIMMER_COMMAND_SET_LEVEL            0x10
 #define DIMMER_COMMAND_FADE                 0x11
 #define DIMMER_COMMAND_READ_CHANNELS        0x12
+#define DIMMER_COMMAND_SET_GROUP_LEVELS     0x13
+#define DIMMER_COMMAND_WRITE_GROUP          0x14
+#define DIMMER_COMMAND_READ_GROUP           0x15
+#define DIMMER_COMMAND_WRITE_SCENE          0x16
+#define DIMMER_COMMAND_READ_SCENE           0x17
+#define DIMMER_COMMAND_RECALL_SCENE         0x18
+#define DIMMER_COMMAND_STORE_SCENE          0x19
+#define DIMMER_COMMAND_FADE_CHANNELS        0x1a
 #define DIMMER_COMMAND_READ_NTC             0x20
 #define DIMMER_COMMAND_READ_INT_TEMP        0x21
 #define DIMMER_COMMAND_READ_VCC             0x22
@@ -91,6 +103,11 @@
 #define DIMMER_COMMAND_FORCE_TEMP_CHECK     0x54
 #define DIMMER_COMMAND_PRINT_METRICS        0x55
 #define DIMMER_COMMAND_SET_MODE             0x56
+#define DIMMER_COMMAND_READ_ISR_STATS       0x57
+#define DIMMER_COMMAND_READ_EVENT_LOG       0x58
+#define DIMMER_COMMAND_READ_CHANGED_CHANNELS 0x59
+#define DIMMER_COMMAND_READ_ZC_PLL          0x5a
+#define DIMMER_COMMAND_READ_ERROR_COUNTERS  0x5b
 #define DIMMER_COMMAND_ZC_TIMINGS_OUTPUT    0x60
 #define DIMMER_COMMAND_PRINT_CONFIG         0x91
 #define DIMMER_COMMAND_WRITE_CONFIG         0x92 // this byte must be send after DIMMER_COMMAND_WRITE_EEPROM_NOW or DIMMER_COMMAND_WRITE_EEPROM
@@ -114,6 +131,28 @@
 #define DIMMER_COMMAND_DUMP_MEM             0xee
 #endif
 //
+// optional byte after DIMMER_COMMAND_FADE
+#define DIMMER_FADE_CURVE_LINEAR            0
+#define DIMMER_FADE_CURVE_EXPONENTIAL       1
+#define DIMMER_FADE_CURVE_S_CURVE           2
+#define DIMMER_FADE_CURVE_PERCEPTUAL        3
+//
+// DIMMER_COMMAND_SET_GROUP_LEVELS, first byte. boards with the group DIMMER_GROUP_NONE ignore the command
+#define DIMMER_GROUP_NONE                   0x00
+#define DIMMER_GROUP_ALL                    0xff
+// general call address, received if DIMMER_HAVE_GROUPS is enabled
+#define DIMMER_I2C_GENERAL_CALL_ADDRESS     0x00
+//
+// DIMMER_COMMAND_READ_ISR_STATS, first byte
+#define DIMMER_ISR_STATS_COMPARE_A          0
+#define DIMMER_ISR_STATS_COMPARE_B          1
+#define DIMMER_ISR_STATS_ZC                 2
+#define DIMMER_ISR_STATS_ADC                3
+#define DIMMER_ISR_STATS_TWI                4
+// second byte
+#define DIMMER_ISR_STATS_READ_HISTOGRAM     0x01
+#define DIMMER_ISR_STATS_RESET              0x80
+//
 // DIMMER_REGISTER_COMMAND_STATUS
 #define DIMMER_COMMAND_STATUS_OK            0
 #define DIMMER_COMMAND_STATUS_ERROR         -1
@@ -126,3 +165,13 @@
 //
 // dimmer_eeprom_written_t.flags
 #define DIMMER_EEPROM_FLAGS_CONFIG_UPDATED  0x01
+//
+// binary frames for the serial bridge (DIMMER_SERIAL_BINARY_FRAMES)
+// DIMMER_FRAME_START, length, type, payload[length], crc16 over length, type and payload (little endian)
+#define DIMMER_FRAME_START                  0x02
+// slave address followed by the data, sent by the master or by the dimmer for events
+#define DIMMER_FRAME_TYPE_TRANSMIT          0x01
+// slave address and number of bytes to read
+#define DIMMER_FRAME_TYPE_REQUEST           0x02
+// slave address followed by the data, response to DIMMER_FRAME_TYPE_REQUEST
+#define DIMMER_FRAME_TYPE_RESPONSE          0x03
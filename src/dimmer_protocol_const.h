@@ -52,9 +52,19 @@
 #define DIMMER_EVENT_FREQUENCY_WARNING           0xf4
 #define DIMMER_EVENT_CHANNEL_ON_OFF              0xf5
 #define DIMMER_EVENT_SYNC_EVENT                  0xf6
+#define DIMMER_EVENT_ISR_STATS                   0xf8
+#define DIMMER_EVENT_COMPOUND                    0xf9
 #define DIMMER_COMMAND_SET_LEVEL                 0x10
 #define DIMMER_COMMAND_FADE                      0x11
 #define DIMMER_COMMAND_READ_CHANNELS             0x12
+#define DIMMER_COMMAND_SET_GROUP_LEVELS          0x13
+#define DIMMER_COMMAND_WRITE_GROUP               0x14
+#define DIMMER_COMMAND_READ_GROUP                0x15
+#define DIMMER_COMMAND_WRITE_SCENE               0x16
+#define DIMMER_COMMAND_READ_SCENE                0x17
+#define DIMMER_COMMAND_RECALL_SCENE              0x18
+#define DIMMER_COMMAND_STORE_SCENE               0x19
+#define DIMMER_COMMAND_FADE_CHANNELS             0x1a
 #define DIMMER_COMMAND_READ_NTC                  0x20
 #define DIMMER_COMMAND_READ_INT_TEMP             0x21
 #define DIMMER_COMMAND_READ_VCC                  0x22
@@ -66,6 +76,11 @@
 #define DIMMER_COMMAND_FORCE_TEMP_CHECK          0x54
 #define DIMMER_COMMAND_PRINT_METRICS             0x55
 #define DIMMER_COMMAND_SET_MODE                  0x56
+#define DIMMER_COMMAND_READ_ISR_STATS            0x57
+#define DIMMER_COMMAND_READ_EVENT_LOG            0x58
+#define DIMMER_COMMAND_READ_CHANGED_CHANNELS     0x59
+#define DIMMER_COMMAND_READ_ZC_PLL               0x5a
+#define DIMMER_COMMAND_READ_ERROR_COUNTERS       0x5b
 #define DIMMER_COMMAND_ZC_TIMINGS_OUTPUT         0x60
 #define DIMMER_COMMAND_PRINT_CONFIG              0x91
 #define DIMMER_COMMAND_WRITE_CONFIG              0x92
@@ -80,6 +95,20 @@
 #define DIMMER_COMMAND_SET_ZC_SYNC               0xec
 #define DIMMER_COMMAND_DUMP_CHANNELS             0xed
 #define DIMMER_COMMAND_DUMP_MEM                  0xee
+#define DIMMER_FADE_CURVE_LINEAR                 0x00
+#define DIMMER_FADE_CURVE_EXPONENTIAL            0x01
+#define DIMMER_FADE_CURVE_S_CURVE                0x02
+#define DIMMER_FADE_CURVE_PERCEPTUAL             0x03
+#define DIMMER_GROUP_NONE                        0x00
+#define DIMMER_GROUP_ALL                         0xff
+#define DIMMER_I2C_GENERAL_CALL_ADDRESS          0x00
+#define DIMMER_ISR_STATS_COMPARE_A               0x00
+#define DIMMER_ISR_STATS_COMPARE_B               0x01
+#define DIMMER_ISR_STATS_ZC                      0x02
+#define DIMMER_ISR_STATS_ADC                     0x03
+#define DIMMER_ISR_STATS_TWI                     0x04
+#define DIMMER_ISR_STATS_READ_HISTOGRAM          0x01
+#define DIMMER_ISR_STATS_RESET                   0x80
 #define DIMMER_COMMAND_STATUS_OK                 0x00
 #define DIMMER_COMMAND_STATUS_ERROR              0xff
 #define DIMMER_OPTIONS_RESTORE_LEVEL             0x01
@@ -87,6 +116,10 @@
 #define DIMMER_OPTIONS_TEMP_ALERT_TRIGGERED      0x04
 #define DIMMER_OPTIONS_NEGATIVE_ZC_DELAY         0x08
 #define DIMMER_EEPROM_FLAGS_CONFIG_UPDATED       0x01
+#define DIMMER_FRAME_START                       0x02
+#define DIMMER_FRAME_TYPE_TRANSMIT               0x01
+#define DIMMER_FRAME_TYPE_REQUEST                0x02
+#define DIMMER_FRAME_TYPE_RESPONSE               0x03
 #define DIMMER_REGISTER_CUBIC_INT_OFS            (DIMMER_REGISTER_RAM)
 #define DIMMER_REGISTER_CUBIC_INT_DATAX(n)       (DIMMER_REGISTER_CUBIC_INT_OFS + ((n) * 2))
 #define DIMMER_REGISTER_CUBIC_INT_DATAY(n)       (DIMMER_REGISTER_CUBIC_INT_OFS + 1 + ((n) * 2))
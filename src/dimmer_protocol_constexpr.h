@@ -74,9 +74,19 @@ static constexpr size_t __DIMMER_EVENT_FREQUENCY_WARNING = DIMMER_EVENT_FREQUENC
 static constexpr size_t __DIMMER_EVENT_CHANNEL_ON_OFF = DIMMER_EVENT_CHANNEL_ON_OFF;
 static constexpr size_t __DIMMER_EVENT_SYNC_EVENT = DIMMER_EVENT_SYNC_EVENT;
 static constexpr size_t __DIMMER_EVENT_RESTART = DIMMER_EVENT_RESTART;
+static constexpr size_t __DIMMER_EVENT_ISR_STATS = DIMMER_EVENT_ISR_STATS;
+static constexpr size_t __DIMMER_EVENT_COMPOUND = DIMMER_EVENT_COMPOUND;
 static constexpr size_t __DIMMER_COMMAND_SET_LEVEL = DIMMER_COMMAND_SET_LEVEL;
 static constexpr size_t __DIMMER_COMMAND_FADE = DIMMER_COMMAND_FADE;
 static constexpr size_t __DIMMER_COMMAND_READ_CHANNELS = DIMMER_COMMAND_READ_CHANNELS;
+static constexpr size_t __DIMMER_COMMAND_SET_GROUP_LEVELS = DIMMER_COMMAND_SET_GROUP_LEVELS;
+static constexpr size_t __DIMMER_COMMAND_WRITE_GROUP = DIMMER_COMMAND_WRITE_GROUP;
+static constexpr size_t __DIMMER_COMMAND_READ_GROUP = DIMMER_COMMAND_READ_GROUP;
+static constexpr size_t __DIMMER_COMMAND_WRITE_SCENE = DIMMER_COMMAND_WRITE_SCENE;
+static constexpr size_t __DIMMER_COMMAND_READ_SCENE = DIMMER_COMMAND_READ_SCENE;
+static constexpr size_t __DIMMER_COMMAND_RECALL_SCENE = DIMMER_COMMAND_RECALL_SCENE;
+static constexpr size_t __DIMMER_COMMAND_STORE_SCENE = DIMMER_COMMAND_STORE_SCENE;
+static constexpr size_t __DIMMER_COMMAND_FADE_CHANNELS = DIMMER_COMMAND_FADE_CHANNELS;
 static constexpr size_t __DIMMER_COMMAND_READ_NTC = DIMMER_COMMAND_READ_NTC;
 static constexpr size_t __DIMMER_COMMAND_READ_INT_TEMP = DIMMER_COMMAND_READ_INT_TEMP;
 static constexpr size_t __DIMMER_COMMAND_READ_VCC = DIMMER_COMMAND_READ_VCC;
@@ -88,6 +98,11 @@ static constexpr size_t __DIMMER_COMMAND_PRINT_INFO = DIMMER_COMMAND_PRINT_INFO;
 static constexpr size_t __DIMMER_COMMAND_FORCE_TEMP_CHECK = DIMMER_COMMAND_FORCE_TEMP_CHECK;
 static constexpr size_t __DIMMER_COMMAND_PRINT_METRICS = DIMMER_COMMAND_PRINT_METRICS;
 static constexpr size_t __DIMMER_COMMAND_SET_MODE = DIMMER_COMMAND_SET_MODE;
+static constexpr size_t __DIMMER_COMMAND_READ_ISR_STATS = DIMMER_COMMAND_READ_ISR_STATS;
+static constexpr size_t __DIMMER_COMMAND_READ_EVENT_LOG = DIMMER_COMMAND_READ_EVENT_LOG;
+static constexpr size_t __DIMMER_COMMAND_READ_CHANGED_CHANNELS = DIMMER_COMMAND_READ_CHANGED_CHANNELS;
+static constexpr size_t __DIMMER_COMMAND_READ_ZC_PLL = DIMMER_COMMAND_READ_ZC_PLL;
+static constexpr size_t __DIMMER_COMMAND_READ_ERROR_COUNTERS = DIMMER_COMMAND_READ_ERROR_COUNTERS;
 static constexpr size_t __DIMMER_COMMAND_ZC_TIMINGS_OUTPUT = DIMMER_COMMAND_ZC_TIMINGS_OUTPUT;
 static constexpr size_t __DIMMER_COMMAND_PRINT_CONFIG = DIMMER_COMMAND_PRINT_CONFIG;
 static constexpr size_t __DIMMER_COMMAND_WRITE_CONFIG = DIMMER_COMMAND_WRITE_CONFIG;
@@ -107,6 +122,20 @@ static constexpr size_t __DIMMER_COMMAND_DECR_HW_TICKS = DIMMER_COMMAND_DECR_HW_
 static constexpr size_t __DIMMER_COMMAND_SET_ZC_SYNC = DIMMER_COMMAND_SET_ZC_SYNC;
 static constexpr size_t __DIMMER_COMMAND_DUMP_CHANNELS = DIMMER_COMMAND_DUMP_CHANNELS;
 static constexpr size_t __DIMMER_COMMAND_DUMP_MEM = DIMMER_COMMAND_DUMP_MEM;
+static constexpr size_t __DIMMER_FADE_CURVE_LINEAR = DIMMER_FADE_CURVE_LINEAR;
+static constexpr size_t __DIMMER_FADE_CURVE_EXPONENTIAL = DIMMER_FADE_CURVE_EXPONENTIAL;
+static constexpr size_t __DIMMER_FADE_CURVE_S_CURVE = DIMMER_FADE_CURVE_S_CURVE;
+static constexpr size_t __DIMMER_FADE_CURVE_PERCEPTUAL = DIMMER_FADE_CURVE_PERCEPTUAL;
+static constexpr size_t __DIMMER_GROUP_NONE = DIMMER_GROUP_NONE;
+static constexpr size_t __DIMMER_GROUP_ALL = DIMMER_GROUP_ALL;
+static constexpr size_t __DIMMER_I2C_GENERAL_CALL_ADDRESS = DIMMER_I2C_GENERAL_CALL_ADDRESS;
+static constexpr size_t __DIMMER_ISR_STATS_COMPARE_A = DIMMER_ISR_STATS_COMPARE_A;
+static constexpr size_t __DIMMER_ISR_STATS_COMPARE_B = DIMMER_ISR_STATS_COMPARE_B;
+static constexpr size_t __DIMMER_ISR_STATS_ZC = DIMMER_ISR_STATS_ZC;
+static constexpr size_t __DIMMER_ISR_STATS_ADC = DIMMER_ISR_STATS_ADC;
+static constexpr size_t __DIMMER_ISR_STATS_TWI = DIMMER_ISR_STATS_TWI;
+static constexpr size_t __DIMMER_ISR_STATS_READ_HISTOGRAM = DIMMER_ISR_STATS_READ_HISTOGRAM;
+static constexpr size_t __DIMMER_ISR_STATS_RESET = DIMMER_ISR_STATS_RESET;
 static constexpr size_t __DIMMER_COMMAND_STATUS_OK = DIMMER_COMMAND_STATUS_OK;
 static constexpr size_t __DIMMER_COMMAND_STATUS_ERROR = DIMMER_COMMAND_STATUS_ERROR;
 static constexpr size_t __DIMMER_OPTIONS_RESTORE_LEVEL = DIMMER_OPTIONS_RESTORE_LEVEL;
@@ -114,3 +143,7 @@ static constexpr size_t __DIMMER_OPTIONS_MODE_LEADING_EDGE = DIMMER_OPTIONS_MODE
 static constexpr size_t __DIMMER_OPTIONS_TEMP_ALERT_TRIGGERED = DIMMER_OPTIONS_TEMP_ALERT_TRIGGERED;
 static constexpr size_t __DIMMER_OPTIONS_NEGATIVE_ZC_DELAY = DIMMER_OPTIONS_NEGATIVE_ZC_DELAY;
 static constexpr size_t __DIMMER_EEPROM_FLAGS_CONFIG_UPDATED = DIMMER_EEPROM_FLAGS_CONFIG_UPDATED;
+static constexpr size_t __DIMMER_FRAME_START = DIMMER_FRAME_START;
+static constexpr size_t __DIMMER_FRAME_TYPE_TRANSMIT = DIMMER_FRAME_TYPE_TRANSMIT;
+static constexpr size_t __DIMMER_FRAME_TYPE_REQUEST = DIMMER_FRAME_TYPE_REQUEST;
+static constexpr size_t __DIMMER_FRAME_TYPE_RESPONSE = DIMMER_FRAME_TYPE_RESPONSE;
@@ -7,10 +7,18 @@
 #include <stdint.h>
 #include <math.h>
 
-#if SERIAL_I2C_BRIDGE
+#if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+
+#include "serial_frames.h"
+
+#elif SERIAL_I2C_BRIDGE
 
 #include "SerialTwoWire.h"
 
+#elif DIMMER_HAVE_TWI_SLAVE
+
+#include "twi_slave.h"
+
 #else
 
 #include <Wire.h>
@@ -230,6 +238,24 @@ struct __attribute_packed__ dimmer_config_cubic_int_t {
     register_mem_cubic_int_t channels[DIMMER_CHANNEL_COUNT];
 };
 
+struct __attribute_packed__ dimmer_config_group_t {
+    uint8_t id;                             // DIMMER_GROUP_NONE or 1-254
+    uint8_t channel_offset;                 // channel 0 is bit channel_offset of the group mask
+};
+
+static_assert(sizeof(dimmer_config_group_t) == 2, "check struct");
+
+struct __attribute_packed__ dimmer_scene_channel_t {
+    int16_t level;                          // -1 to keep the channel unchanged
+    uint16_t time;                          // fading time in 1/100 seconds, 0 to set the level
+};
+
+static_assert(sizeof(dimmer_scene_channel_t) == 4, "check struct");
+
+struct __attribute_packed__ dimmer_config_scenes_t {
+    dimmer_scene_channel_t scenes[DIMMER_SCENE_COUNT][DIMMER_CHANNEL_COUNT];
+};
+
 struct __attribute_packed__ dimmer_get_cubic_int_header_t {
     int16_t start_level;
     uint8_t level_count;
@@ -342,6 +368,65 @@ struct __attribute_packed__ dimmer_version_info_t
     dimmer_config_info_t info;
 };
 
+// clock cycles
+struct __attribute_packed__ dimmer_isr_stats_t
+{
+    uint16_t count;
+    uint16_t min;
+    uint16_t max;
+    uint16_t avg;
+    uint16_t latency_max;
+    uint16_t latency_avg;
+};
+
+static_assert(sizeof(dimmer_isr_stats_t) == 12, "check struct");
+
+// number of calls with a duration below 64, 128, 256, ... clock cycles, the last entry all others
+struct __attribute_packed__ dimmer_isr_histogram_t
+{
+    uint16_t counts[8];
+};
+
+static_assert(sizeof(dimmer_isr_histogram_t) == 16, "check struct");
+
+struct __attribute_packed__ dimmer_isr_stats_event_t
+{
+    uint8_t type;
+    dimmer_isr_stats_t stats;
+};
+
+static_assert(sizeof(dimmer_isr_stats_event_t) == 13, "check struct");
+
+// DIMMER_COMMAND_READ_ZC_PLL
+struct __attribute_packed__ dimmer_zc_pll_t
+{
+    uint32_t period;                        // length of the half wave in 1/256 clock cycles
+    int16_t phase_error;                    // last phase error in clock cycles, positive if the edge was late
+    uint16_t avg_phase_error;               // average of the absolute phase error in clock cycles
+    uint16_t rejected;                      // edges with a phase error above DIMMER_ZC_INTERVAL_MAX_DEVIATION
+    uint16_t missed;                        // zero crossings without edge
+    uint8_t lock_count;                     // consecutive edges that have not been rejected, max. 255
+    uint8_t locked;                         // lock_count >= 16 and avg_phase_error below DIMMER_ZC_PLL_LOCK_THRESHOLD_US
+    uint16_t flywheel;                      // half waves started from the prediction (DIMMER_ZC_FLYWHEEL_HALFWAVES)
+};
+
+static_assert(sizeof(dimmer_zc_pll_t) == 16, "check struct");
+
+// DIMMER_COMMAND_READ_ERROR_COUNTERS
+// counters that are not part of register_mem_errors_t to keep the registers after DIMMER_REGISTER_ERRORS at the same address
+struct __attribute_packed__ dimmer_error_counters_t
+{
+    uint8_t level_queue_overflow;           // commands dropped because the queue was full (DIMMER_USE_QUEUE_LEVELS)
+    uint8_t event_queue_overflow;           // events dropped because the queue was full (DIMMER_HAVE_EVENT_QUEUE)
+    uint8_t event_send_failed;              // events dropped after the last retry (DIMMER_HAVE_EVENT_QUEUE)
+    uint8_t zc_blanked;                     // edges within the blanking window (DIMMER_ZC_FILTER)
+    uint8_t zc_pulse_width;                 // pulses shorter than DIMMER_ZC_FILTER_MIN_PULSE_US (DIMMER_ZC_FILTER)
+    uint8_t zc_interval;                    // edges that failed the N-of-M validation (DIMMER_ZC_FILTER)
+    uint8_t event_send_busy;                // events not sent while another event was being sent (no DIMMER_HAVE_EVENT_QUEUE)
+};
+
+static_assert(sizeof(dimmer_error_counters_t) == 7, "check struct");
+
 union __attribute_packed__ register_mem_ram_t
 {
     dimmer_timers_t timers;
@@ -352,6 +437,12 @@ union __attribute_packed__ register_mem_ram_t
     uint16_t words[8];
     uint8_t bytes[16];
     register_mem_cubic_int_t cubic_int;
+    dimmer_config_group_t group;
+    dimmer_scene_channel_t scene[4];
+    dimmer_isr_stats_t isr_stats;
+    dimmer_isr_histogram_t isr_histogram;
+    dimmer_zc_pll_t zc_pll;
+    dimmer_error_counters_t error_counters;
 };
 
 struct __attribute_packed__ register_mem_metrics_t {
@@ -430,6 +521,28 @@ struct __attribute_packed__ dimmer_eeprom_written_t
 
 static_assert(sizeof(dimmer_eeprom_written_t) == 8, "check struct");
 
+// response to DIMMER_COMMAND_READ_EVENT_LOG, followed by the log entries
+struct __attribute_packed__ dimmer_event_log_t
+{
+    uint16_t first_sequence;                // oldest event in the log
+    uint16_t next_sequence;                 // sequence number of the next event
+};
+
+static_assert(sizeof(dimmer_event_log_t) == 4, "check struct");
+
+// response to DIMMER_COMMAND_READ_CHANGED_CHANNELS, followed by the level of each channel in channels
+struct __attribute_packed__ dimmer_changed_channels_t
+{
+    uint16_t version;                       // version to pass with the next command
+#if DIMMER_MAX_CHANNELS > 8
+    uint16_t channels;                      // bitset of the channels
+#else
+    uint8_t channels;
+#endif
+};
+
+static_assert(sizeof(dimmer_changed_channels_t) == (DIMMER_MAX_CHANNELS > 8 ? 4 : 3), "check struct");
+
 struct __attribute_packed__ dimmer_fading_complete_event_t
 {
     uint8_t channel;
@@ -518,6 +631,51 @@ struct __attribute_packed__ dimmer_command_fade_t {
 
 static_assert(sizeof(dimmer_command_fade_t) == 11, "check struct");
 
+// DIMMER_COMMAND_FADE followed by DIMMER_FADE_CURVE_*
+struct __attribute_packed__ dimmer_command_fade_curve_t : dimmer_command_fade_t {
+    uint8_t curve;
+
+    dimmer_command_fade_curve_t() = default;
+
+    dimmer_command_fade_curve_t(uint8_t p_channel, int16_t p_from_level, int16_t p_to_level, float time, uint8_t p_curve) :
+        dimmer_command_fade_t(p_channel, p_from_level, p_to_level, time),
+        curve(p_curve)
+    {}
+};
+
+static_assert(sizeof(dimmer_command_fade_curve_t) == 12, "check struct");
+
+// DIMMER_COMMAND_FADE_CHANNELS is followed by one or more dimmer_fade_channel_t
+struct __attribute_packed__ dimmer_fade_channel_t {
+    int8_t channel;
+    int16_t to_level;
+    float time;                             // time for fading from Level::min to Level::max, same as DIMMER_COMMAND_FADE
+};
+
+static_assert(sizeof(dimmer_fade_channel_t) == 7, "check struct");
+
+// DIMMER_COMMAND_SET_GROUP_LEVELS followed by one int16_t level for each bit set in the mask
+// if there are less levels than bits, the last level is used for the remaining channels
+struct __attribute_packed__ dimmer_command_group_levels_t {
+    uint8_t register_address;
+    float time;                             // fade time for Level::min to Level::max, 0 to set the level
+    uint8_t command;
+    uint8_t group;                          // group id or DIMMER_GROUP_ALL
+    uint64_t mask;                          // bit n is channel n of the group
+
+    dimmer_command_group_levels_t() = default;
+
+    dimmer_command_group_levels_t(uint8_t p_group, uint64_t p_mask, float p_time) :
+        register_address(DIMMER_REGISTER_TIME),
+        time(p_time),
+        command(DIMMER_COMMAND_SET_GROUP_LEVELS),
+        group(p_group),
+        mask(p_mask)
+    {}
+};
+
+static_assert(sizeof(dimmer_command_group_levels_t) == 15, "check struct");
+
 namespace Dimmer  {
 
     using VersionType = dimmer_version_t;
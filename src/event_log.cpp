@@ -0,0 +1,85 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if DIMMER_HAVE_EVENT_LOG
+
+#include "dimmer.h"
+#include "event_log.h"
+
+using namespace Dimmer;
+
+EventLog Dimmer::event_log;
+
+// the response must contain at least one event
+static constexpr uint8_t kMaxEntryLength = DIMMER_EVENT_LOG_READ_SIZE - sizeof(dimmer_event_log_t);
+
+static_assert(kMaxEntryLength <= EventLog::kSize, "the log is too small");
+
+void EventLog::add(const uint8_t *header, uint8_t headerLength, const uint8_t *data, uint8_t length)
+{
+    length = std::min<uint8_t>(length, kMaxEntryLength - 1 - headerLength);
+    uint8_t size = 1 + headerLength + length;
+
+    // remove the oldest events
+    uint8_t tail = _tail;
+    while (static_cast<uint8_t>(kSize - static_cast<uint8_t>(_head - tail)) < size) {
+        tail += _buffer[tail & kMask] + 1;
+        _tail = tail;
+    }
+
+    uint8_t pos = _head;
+    _buffer[pos++ & kMask] = size - 1;
+    for(uint8_t i = 0; i < headerLength; i++) {
+        _buffer[pos++ & kMask] = header[i];
+    }
+    for(uint8_t i = 0; i < length; i++) {
+        _buffer[pos++ & kMask] = data[i];
+    }
+    // the entry must be stored before it is published
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _head = pos;
+        _sequence++;
+    }
+}
+
+// sequence number of the entry at pos
+static inline uint16_t _get_sequence(const uint8_t *buffer, uint8_t pos)
+{
+    return buffer[(pos + 2) & EventLog::kMask] | (buffer[(pos + 3) & EventLog::kMask] << 8);
+}
+
+uint16_t EventLog::firstSequence() const
+{
+    return _tail == _head ? _sequence : _get_sequence(_buffer, _tail);
+}
+
+void EventLog::read(uint16_t sequence, uint8_t maxLength)
+{
+    dimmer_event_log_t header = { firstSequence(), _sequence };
+    // TwiSlave::write() only copies single bytes, the buffer would be replaced by the events
+    for(uint8_t i = 0; i < sizeof(header); i++) {
+        Wire.write(reinterpret_cast<const uint8_t *>(&header)[i]);
+    }
+    maxLength -= sizeof(header);
+
+    uint8_t pos = _tail;
+    uint8_t head = _head;
+    while (pos != head) {
+        uint8_t size = _buffer[pos & kMask] + 1;
+        if (static_cast<int16_t>(_get_sequence(_buffer, pos) - sequence) >= 0) {
+            if (size > maxLength) {
+                break;
+            }
+            maxLength -= size;
+            for(uint8_t i = 0; i < size; i++) {
+                Wire.write(_buffer[(pos + i) & kMask]);
+            }
+        }
+        pos += size;
+    }
+}
+
+#endif
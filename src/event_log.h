@@ -0,0 +1,54 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// log of the last events sent to the master (DIMMER_HAVE_EVENT_LOG)
+//
+// each event gets a 16 bit sequence number after the event id. the events are stored in a ring buffer of
+// DIMMER_EVENT_LOG_SIZE byte, the oldest events are removed if there is not enough space. a master that
+// missed events can read all events starting with the next sequence number it expects with
+// DIMMER_COMMAND_READ_EVENT_LOG
+//
+// add() is called from loop() and read() from the I2C request handler, which can interrupt add(). the
+// head index is changed after the data has been written, the tail before the data is overwritten
+
+#pragma once
+
+#include <Arduino.h>
+#include "dimmer_def.h"
+
+namespace Dimmer {
+
+    class EventLog {
+    public:
+        static constexpr uint8_t kSize = DIMMER_EVENT_LOG_SIZE;
+        static constexpr uint8_t kMask = kSize - 1;
+
+        static_assert(kSize >= 32 && kSize <= 128 && (kSize & kMask) == 0, "size must be a power of 2");
+
+        // sequence number of the next event
+        uint16_t sequence() const {
+            return _sequence;
+        }
+
+        // sequence number of the oldest event in the log
+        uint16_t firstSequence() const;
+
+        // the header is the event id, the sequence number and an optional byte before the data
+        void add(const uint8_t *header, uint8_t headerLength, const uint8_t *data, uint8_t length);
+
+        // write dimmer_event_log_t and the events starting with sequence number that fit into maxLength.
+        // each event is the length followed by the event id, sequence number and payload
+        void read(uint16_t sequence, uint8_t maxLength);
+
+    private:
+        uint8_t _buffer[kSize];
+        // free running indices
+        volatile uint8_t _head{0};
+        volatile uint8_t _tail{0};
+        uint16_t _sequence{0};
+    };
+
+    extern EventLog event_log;
+
+}
@@ -0,0 +1,200 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if DIMMER_HAVE_EVENT_QUEUE
+
+#include <util/atomic.h>
+#include "dimmer.h"
+#include "event_queue.h"
+
+using namespace Dimmer;
+
+EventQueue Dimmer::event_queue;
+
+void EventQueue::push(const uint8_t *header, uint8_t headerLength, const uint8_t *data, uint8_t length)
+{
+    uint8_t id = header[0];
+    Event *event = nullptr;
+    // events that are being sent cannot be replaced
+    for(uint8_t i = _sending; i < _count; i++) {
+        auto &item = _at(i);
+        if (item.data[0] == id && (id != DIMMER_EVENT_ISR_STATS || item.data[headerLength] == data[0])) {
+            event = &item;
+            break;
+        }
+    }
+    if (event) {
+        #if HAVE_FADE_COMPLETION_EVENT
+            if (id == DIMMER_EVENT_FADING_COMPLETE) {
+                _mergeFadingEvents(*event, headerLength, data, length);
+                memcpy(event->data, header, headerLength);
+                return;
+            }
+        #endif
+    }
+    else {
+        if (_count >= kSize) {
+            if (error_counters.event_queue_overflow != 0xff) {
+                error_counters.event_queue_overflow++;
+            }
+            return;
+        }
+        #if DIMMER_HAVE_COMPOUND_EVENTS
+            if (_count == 0) {
+                _pushTime = millis();
+            }
+        #endif
+        event = &_at(_count++);
+    }
+    length = std::min<uint8_t>(length, kDataSize - headerLength);
+    memcpy(event->data, header, headerLength);
+    memcpy(event->data + headerLength, data, length);
+    event->length = headerLength + length;
+}
+
+#if HAVE_FADE_COMPLETION_EVENT
+
+    // update the level of channels that are already in the event and append the others
+    void EventQueue::_mergeFadingEvents(Event &event, uint8_t headerLength, const uint8_t *data, uint8_t length)
+    {
+        auto src = reinterpret_cast<const dimmer_fading_complete_event_t *>(data);
+        auto srcEnd = src + (length / sizeof(*src));
+        for(; src < srcEnd; src++) {
+            auto dst = reinterpret_cast<dimmer_fading_complete_event_t *>(&event.data[headerLength]);
+            auto dstEnd = dst + ((event.length - headerLength) / sizeof(*dst));
+            while (dst < dstEnd && dst->channel != src->channel) {
+                dst++;
+            }
+            if (dst != dstEnd) {
+                *dst = *src;
+            }
+            else if (event.length + sizeof(*src) <= kDataSize) {
+                *dst = *src;
+                event.length += sizeof(*src);
+            }
+            else if (error_counters.event_queue_overflow != 0xff) {
+                error_counters.event_queue_overflow++;
+            }
+        }
+    }
+
+#endif
+
+// push() can interrupt loop() from the I2C receive handler
+void EventQueue::_pop(uint8_t count)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        _head = _index(count);
+        _count -= count;
+    }
+    _retries = 0;
+}
+
+#if DIMMER_HAVE_COMPOUND_EVENTS
+
+    // copy the events that fit into _compound and return the number of events
+    uint8_t EventQueue::_pack()
+    {
+        uint8_t length = 1;
+        uint8_t count = 0;
+        while (count < _count && length + sizeof(Event::length) + _at(count).length <= kDataSize) {
+            length += sizeof(Event::length) + _at(count).length;
+            count++;
+        }
+        if (count < 2) {
+            return 1;
+        }
+        auto ptr = _compound.data;
+        *ptr++ = DIMMER_EVENT_COMPOUND;
+        for(uint8_t i = 0; i < count; i++) {
+            // length, event id and payload
+            auto &event = _at(i);
+            auto size = sizeof(event.length) + event.length;
+            memcpy(ptr, &event, size);
+            ptr += size;
+        }
+        _compound.length = length;
+        return count;
+    }
+
+#endif
+
+#if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+
+    static_assert(EventQueue::kBusy == TwiSlave::kTransmitBusy, "invalid value");
+
+    inline bool EventQueue::_transmit(const Event &event)
+    {
+        return Wire.transmit(DIMMER_I2C_MASTER_ADDRESS, event.data, event.length);
+    }
+
+    inline uint8_t EventQueue::_result() const
+    {
+        return Wire.transmitResult();
+    }
+
+#else
+
+    // blocking
+    inline bool EventQueue::_transmit(const Event &event)
+    {
+        Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
+        Wire.write(event.data, event.length);
+        _lastResult = Wire.endTransmission();
+        return true;
+    }
+
+    inline uint8_t EventQueue::_result() const
+    {
+        return _lastResult;
+    }
+
+#endif
+
+void EventQueue::loop()
+{
+    if (_sending) {
+        uint8_t result = _result();
+        if (result == kBusy) {
+            return;
+        }
+        uint8_t count = _sending;
+        _sending = 0;
+        if (result && _retries < DIMMER_EVENT_QUEUE_RETRIES) {
+            _D(5, debug_printf("event %02x failed, result=%u retry=%u\n", _at(0).data[0], result, _retries));
+            _retryTime = static_cast<uint16_t>(millis()) + (DIMMER_EVENT_QUEUE_BACKOFF_MILLIS << _retries);
+            _retries++;
+            return;
+        }
+        if (result) {
+            auto &failed = error_counters.event_send_failed;
+            failed = std::min<uint16_t>(0xff, failed + count);
+        }
+        _pop(count);
+    }
+    if (_count == 0 || (_retries && static_cast<int16_t>(static_cast<uint16_t>(millis()) - _retryTime) < 0)) {
+        return;
+    }
+    #if DIMMER_HAVE_COMPOUND_EVENTS
+        if (_retries == 0 && static_cast<uint16_t>(static_cast<uint16_t>(millis()) - _pushTime) < DIMMER_COMPOUND_EVENTS_DELAY_MILLIS) {
+            return;
+        }
+        // push() must not replace the events while they are packed and sent
+        _sending = kSize;
+        auto count = _pack();
+        _sending = count;
+        if (!_transmit(count > 1 ? _compound : _at(0))) {
+            _sending = 0;
+        }
+    #else
+        _sending = 1;
+        if (!_transmit(_at(0))) {
+            _sending = 0;
+        }
+    #endif
+}
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// queue for events sent to the master (DIMMER_HAVE_EVENT_QUEUE)
+//
+// DimmerEvent::send() copies the event into the queue and returns. loop() calls event_queue.loop(), which
+// sends the oldest event. with DIMMER_HAVE_TWI_SLAVE, the event is transmitted by the TWI interrupt and loop()
+// only checks the result. the Wire library and the serial bridge block in endTransmission() for one event
+// per call
+//
+// if the master does not acknowledge the event, it is sent again after DIMMER_EVENT_QUEUE_BACKOFF_MILLIS,
+// which is doubled for each retry. events that fail DIMMER_EVENT_QUEUE_RETRIES times or do not fit into the
+// queue are counted in error_counters (dimmer_error_counters_t, DIMMER_COMMAND_READ_ERROR_COUNTERS)
+//
+// an event replaces a queued event of the same type that is not being sent. DIMMER_EVENT_ISR_STATS is
+// replaced per type and DIMMER_EVENT_FADING_COMPLETE per channel
+//
+// with DIMMER_HAVE_COMPOUND_EVENTS, the queue waits DIMMER_COMPOUND_EVENTS_DELAY_MILLIS for more events and
+// sends all events from the start of the queue that fit into one DIMMER_EVENT_COMPOUND. a single event is
+// sent as it is
+//
+// push() can be called from the I2C receive handler and interrupt loop(). send_event() calls it with interrupts
+// disabled, the events are kept in a ring buffer, loop() removes them with interrupts disabled and push() does
+// not replace events that are being sent
+
+#pragma once
+
+#include <Arduino.h>
+#include "dimmer_def.h"
+
+namespace Dimmer {
+
+    class EventQueue {
+    public:
+        static constexpr uint8_t kSize = DIMMER_EVENT_QUEUE_SIZE;
+        static constexpr uint8_t kDataSize = DIMMER_EVENT_QUEUE_DATA_SIZE;
+        // _result() while the transmission is in progress
+        static constexpr uint8_t kBusy = 0xff;
+
+        struct Event {
+            uint8_t length;
+            // event id followed by the payload
+            uint8_t data[kDataSize];
+        };
+
+        // the header is the event id and the bytes that are sent before the data
+        void push(const uint8_t *header, uint8_t headerLength, const uint8_t *data, uint8_t length);
+
+        // start sending the next event or check the result of the current transmission
+        void loop();
+
+        bool empty() const {
+            return _count == 0;
+        }
+
+    private:
+        // position of the event in the ring buffer
+        uint8_t _index(uint8_t index) const {
+            index += _head;
+            return index < kSize ? index : index - kSize;
+        }
+        Event &_at(uint8_t index) {
+            return _events[_index(index)];
+        }
+
+        void _pop(uint8_t count);
+        #if DIMMER_HAVE_COMPOUND_EVENTS
+            uint8_t _pack();
+        #endif
+        #if HAVE_FADE_COMPLETION_EVENT
+            void _mergeFadingEvents(Event &event, uint8_t headerLength, const uint8_t *data, uint8_t length);
+        #endif
+        bool _transmit(const Event &event);
+        uint8_t _result() const;
+
+    private:
+        Event _events[kSize];
+        // first event of the ring buffer
+        uint8_t _head{0};
+        uint8_t _count{0};
+        // number of events from the start of the queue that are being sent
+        uint8_t _sending{0};
+        uint8_t _retries{0};
+        // millis() of the next retry
+        uint16_t _retryTime;
+        #if DIMMER_HAVE_COMPOUND_EVENTS
+            Event _compound;
+            // millis() when the first event has been added to the empty queue
+            uint16_t _pushTime;
+        #endif
+        #if !DIMMER_HAVE_TWI_SLAVE || SERIAL_I2C_BRIDGE
+            uint8_t _lastResult;
+        #endif
+    };
+
+    extern EventQueue event_queue;
+
+}
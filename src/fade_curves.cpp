@@ -0,0 +1,21 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "fade_curves.h"
+
+#if DIMMER_HAVE_FADE_CURVES
+
+using namespace Dimmer;
+
+// f(t) for t = n / 32, scaled to 0-32768
+const uint16_t FadeCurve::table[FadeCurve::kNumCurves][FadeCurve::kSize] PROGMEM = {
+    // EXPONENTIAL (64^t - 1) / 63
+    { 0, 72, 154, 248, 355, 476, 614, 772, 951, 1155, 1388, 1652, 1954, 2297, 2688, 3134, 3641, 4218, 4876, 5625, 6478, 7449, 8555, 9815, 11249, 12882, 14743, 16861, 19273, 22020, 25149, 28711, 32768 },
+    // S_CURVE 3t^2 - 2t^3
+    { 0, 94, 368, 810, 1408, 2150, 3024, 4018, 5120, 6318, 7600, 8954, 10368, 11830, 13328, 14850, 16384, 17918, 19440, 20938, 22400, 23814, 25168, 26450, 27648, 28750, 29744, 30618, 31360, 31958, 32400, 32674, 32768 },
+    // PERCEPTUAL CIE 1931 luminance for the lightness L* = 100t, ((L* + 16) / 116)^3 or L* / 903.3 for L* <= 8
+    { 0, 113, 227, 343, 486, 664, 881, 1141, 1447, 1804, 2215, 2684, 3215, 3812, 4478, 5218, 6035, 6934, 7918, 8990, 10155, 11417, 12779, 14245, 15820, 17506, 19308, 21230, 23275, 25448, 27752, 30190, 32768 }
+};
+
+#endif
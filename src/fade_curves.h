@@ -0,0 +1,55 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <avr/pgmspace.h>
+#include "dimmer_def.h"
+#include "dimmer_protocol.h"
+
+namespace Dimmer {
+
+    enum class FadeCurveType : uint8_t {
+        LINEAR = DIMMER_FADE_CURVE_LINEAR,
+        EXPONENTIAL = DIMMER_FADE_CURVE_EXPONENTIAL,
+        S_CURVE = DIMMER_FADE_CURVE_S_CURVE,
+        PERCEPTUAL = DIMMER_FADE_CURVE_PERCEPTUAL,
+        MAX
+    };
+
+    #if DIMMER_HAVE_FADE_CURVES
+
+        // piecewise linear tables for the fading curves
+        //
+        // the progress of the fading (0-0xffff) is mapped to 0-kMaxValue and multiplied with the difference
+        // of the levels. fading down uses the mirrored curve to keep it slow at the bottom
+        struct FadeCurve {
+            static constexpr uint8_t kShift = 11;
+            static constexpr uint16_t kMask = (1 << kShift) - 1;
+            static constexpr uint8_t kSize = (0x10000UL >> kShift) + 1;
+            static constexpr uint8_t kValueBits = 15;
+            static constexpr uint16_t kMaxValue = 1 << kValueBits;
+            static constexpr uint8_t kNumCurves = static_cast<uint8_t>(FadeCurveType::MAX) - 1;
+
+            // tables for all curves except LINEAR
+            static const uint16_t table[kNumCurves][kSize] PROGMEM;
+
+            static uint16_t get(FadeCurveType curve, uint16_t progress, bool mirrored);
+        };
+
+        inline uint16_t FadeCurve::get(FadeCurveType curve, uint16_t progress, bool mirrored)
+        {
+            if (mirrored) {
+                progress = ~progress;
+            }
+            auto ptr = &table[static_cast<uint8_t>(curve) - 1][progress >> kShift];
+            uint16_t start = pgm_read_word(ptr);
+            uint16_t value = start + static_cast<uint16_t>((static_cast<uint32_t>(pgm_read_word(ptr + 1) - start) * (progress & kMask)) >> kShift);
+            return mirrored ? kMaxValue - value : value;
+        }
+
+    #endif
+
+}
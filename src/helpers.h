@@ -66,6 +66,13 @@ static inline void __debug_printf_i(uint16_t interval, const char *format, ...)
 #define _ASSERT_EXPR(cond, expr, ...)       ( (!(cond)) ? debug_printf(expr, _STRINGIFY(cond), ##__VA_ARGS__) + assert_failed() : 0 )
 #endif
 
+#if DIMMER_NATIVE
+
+#include <algorithm>
+#include <memory>
+
+#else
+
 namespace std {
 
     template <typename _Ta, typename _Tpred>
@@ -129,6 +136,14 @@ namespace std {
         return max<_Ta>(max<_Ta>(max<_Ta>(a, b), c), d);
     }
 
+    template<typename _Ta>
+    void swap(_Ta &a, _Ta &b)
+    {
+        _Ta tmp = a;
+        a = b;
+        b = tmp;
+    }
+
     template< typename T > class unique_ptr
     {
     public:
@@ -149,6 +164,8 @@ namespace std {
 
 }
 
+#endif
+
 #ifndef FPSTR
 #define FPSTR(str)                              reinterpret_cast<const __FlashStringHelper *>(str)
 #endif
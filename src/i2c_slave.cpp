@@ -7,8 +7,10 @@
 #include "dimmer.h"
 #include "measure_frequency.h"
 #include "main.h"
+#include "isr_stats.h"
 
 register_mem_union_t register_mem;
+dimmer_error_counters_t error_counters;
 
 inline uint8_t validate_register_address()
 {
@@ -21,7 +23,20 @@ inline uint8_t validate_register_address()
 
 void i2c_write_to_register(uint8_t data)
 {
-    register_mem.raw[validate_register_address()] = data;
+    uint8_t offset = validate_register_address();
+    register_mem.raw[offset] = data;
+    // mark the channel as changed if the level or all channels if the configuration has been modified
+    offset += DIMMER_REGISTER_START_ADDR;
+    if (offset >= DIMMER_REGISTER_CH0_LEVEL && offset < DIMMER_REGISTER_CHANNELS_END) {
+        Dimmer::Channel::type channel = (offset - DIMMER_REGISTER_CH0_LEVEL) / sizeof(register_mem.data.channels.level[0]);
+        #if DIMMER_HAVE_STATE_VERSION
+            dimmer.set_channel_changed(channel);
+        #endif
+        dimmer.set_channels_dirty(1 << channel);
+    }
+    else if (offset >= DIMMER_REGISTER_OPTIONS && offset < DIMMER_REGISTER_OPTIONS + sizeof(register_mem.data.cfg)) {
+        dimmer.set_channels_dirty();
+    }
     _D(5, debug_printf("I2C write to %#02x: %#02x (%u, %d)\n", validate_register_address() + DIMMER_REGISTER_START_ADDR , data, data, (int8_t)data));
     register_mem.data.address++;
 }
@@ -50,12 +65,171 @@ uint8_t Wire_read_uint8_t(int &length, uint8_t default_value)
     return default_value;
 }
 
-void _dimmer_i2c_on_receive(int length)
+// start fading all channels in the same half wave. the fading is calculated with interrupts enabled
+// and the interrupts are disabled only to copy the results
+static void _dimmer_i2c_start_fading(const Dimmer::PreparedFadingType *prepared)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        DIMMER_CHANNEL_LOOP(i) {
+            dimmer.start_fading(i, prepared[i]);
+        }
+    }
+}
+
+// start fading all channels of DIMMER_COMMAND_FADE_CHANNELS in the same half wave. the channels are
+// not passed through queues.levels, which is processed in the main loop
+static void _dimmer_i2c_fade_channels(int &length)
+{
+    Dimmer::PreparedFadingType prepared[Dimmer::Channel::size()] = {};
+    dimmer_fade_channel_t fade;
+    while(length >= static_cast<int>(sizeof(fade))) {
+        length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&fade), sizeof(fade));
+        _D(5, debug_printf("I2C fade ch=%d to=%d t=%f\n", fade.channel, fade.to_level, fade.time));
+        #if DIMMER_HAVE_SET_ALL_CHANNELS_AT_ONCE
+            if (fade.channel == Dimmer::Channel::any) {
+                DIMMER_CHANNEL_LOOP(i) {
+                    dimmer.prepare_fading(i, Dimmer::Level::current, fade.to_level, fade.time, false, Dimmer::FadeCurveType::LINEAR, prepared[i]);
+                }
+                continue;
+            }
+        #endif
+        if (static_cast<uint8_t>(fade.channel) < Dimmer::Channel::size()) {
+            dimmer.prepare_fading(fade.channel, Dimmer::Level::current, fade.to_level, fade.time, false, Dimmer::FadeCurveType::LINEAR, prepared[fade.channel]);
+        }
+    }
+    _dimmer_i2c_start_fading(prepared);
+    // discard incomplete data
+    while(length > 0) {
+        Wire.read();
+        length--;
+    }
+}
+
+#if DIMMER_HAVE_GROUPS
+
+// apply the levels of DIMMER_COMMAND_SET_GROUP_LEVELS to the channels of this board. all levels are
+// read from the buffer, otherwise they would be written to the registers. all channels start in the same
+// half wave like DIMMER_COMMAND_FADE_CHANNELS
+static void _dimmer_i2c_set_group_levels(int &length, float time)
+{
+    uint8_t group = Wire_read_uint8_t(length, DIMMER_GROUP_NONE);
+    uint8_t mask[sizeof(dimmer_command_group_levels_t().mask)] = {};
+    if (length >= static_cast<int>(sizeof(mask))) {
+        length -= Wire.readBytes(mask, sizeof(mask));
+    }
+    const auto &config = conf.config().group;
+    bool member = config.id != DIMMER_GROUP_NONE && (group == DIMMER_GROUP_ALL || group == config.id);
+    int16_t level = Dimmer::Level::invalid;
+    Dimmer::PreparedFadingType prepared[Dimmer::Channel::size()] = {};
+    _D(5, debug_printf("I2C group=%u member=%u t=%f\n", group, member, time));
+
+    for(uint8_t n = 0; n < sizeof(mask) * 8; n++) {
+        if (mask[n >> 3] & (1 << (n & 7))) {
+            // keep the last level if there is no more data
+            if (length >= static_cast<int>(sizeof(level))) {
+                length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&level), sizeof(level));
+            }
+            uint8_t channel = n - config.channel_offset;
+            if (!member || channel >= Dimmer::Channel::size() || level == Dimmer::Level::invalid) {
+                continue;
+            }
+            // without fading time, from and to are the same and the level is set
+            dimmer.prepare_fading(channel, time > 0 ? Dimmer::Level::current : level, level, time, false, Dimmer::FadeCurveType::LINEAR, prepared[channel]);
+        }
+    }
+    _dimmer_i2c_start_fading(prepared);
+    while(length > 0) {
+        Wire.read();
+        length--;
+    }
+}
+
+// transaction sent to DIMMER_I2C_GENERAL_CALL_ADDRESS. only DIMMER_COMMAND_SET_GROUP_LEVELS with the fade time
+// (dimmer_command_group_levels_t) is accepted and the registers are not modified, any other write is dropped
+static void _dimmer_i2c_on_general_call(int length)
+{
+    static constexpr int kHeaderSize = offsetof(dimmer_command_group_levels_t, group);
+    dimmer_command_group_levels_t header;
+    if (length >= kHeaderSize) {
+        length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&header), kHeaderSize);
+        if (header.register_address == DIMMER_REGISTER_TIME && header.command == DIMMER_COMMAND_SET_GROUP_LEVELS) {
+            _dimmer_i2c_set_group_levels(length, header.time);
+            return;
+        }
+    }
+    _D(5, debug_printf("I2C general call dropped\n"));
+    while(length > 0) {
+        Wire.read();
+        length--;
+    }
+}
+
+#endif
+
+#if DIMMER_HAVE_SCENES
+
+// start fading all channels of the scene in the same half wave. the scene is applied directly and
+// not through queues.levels, which might spread the channels over several half waves
+static void _dimmer_i2c_recall_scene(uint8_t scene)
+{
+    const auto &channels = conf.config().scenes.scenes[scene];
+    _D(5, debug_printf("I2C recall scene=%u\n", scene));
+    Dimmer::PreparedFadingType prepared[Dimmer::Channel::size()] = {};
+    DIMMER_CHANNEL_LOOP(i) {
+        const auto &channel = channels[i];
+        if (channel.level == Dimmer::Level::invalid) {
+            // not part of the scene
+        }
+        else if (channel.time) {
+            dimmer.prepare_fading(i, Dimmer::Level::current, channel.level, channel.time / 100.0f, true, Dimmer::FadeCurveType::LINEAR, prepared[i]);
+        }
+        else {
+            prepared[i].fade.targetLevel = channel.level;
+            prepared[i].action = Dimmer::PreparedFadingType::Action::SET_LEVEL;
+        }
+    }
+    _dimmer_i2c_start_fading(prepared);
+}
+
+#endif
+
+#if DIMMER_HAVE_EVENT_LOG
+
+// set by DIMMER_COMMAND_READ_EVENT_LOG until the next write
+static bool _event_log_read;
+static uint16_t _event_log_sequence;
+
+#endif
+
+#if DIMMER_HAVE_STATE_VERSION
+
+// response of DIMMER_COMMAND_READ_CHANGED_CHANNELS, the length is set until the next write
+static uint8_t _changed_channels[DIMMER_CHANGED_CHANNELS_READ_SIZE];
+static uint8_t _changed_channels_length;
+
+static_assert(DIMMER_CHANGED_CHANNELS_READ_SIZE >= sizeof(dimmer_changed_channels_t) + sizeof(register_mem.data.channels.level[0]), "DIMMER_CHANGED_CHANNELS_READ_SIZE too small");
+
+#endif
+
+// legacy version request
+//
+// +i2ct=17,8a,02,b9
+// +i2cr=17,07
+//
+// older versions will respond with 2 byte for the version and the rest filled with 0xff
+static void _dimmer_i2c_version_request()
+{
+    if (register_mem.data.address == 0xb9 && register_mem.data.cmd.read_length == 2) {
+        _D(5, debug_printf("I2C version request\n"));
+        register_mem.data.ram.v.version._word = Dimmer::Version::kVersion;
+        register_mem.data.ram.v.info = { Dimmer::Level::max, Dimmer::Channel::kSize, DIMMER_REGISTER_OPTIONS, sizeof(register_mem.data.cfg) };
+        register_mem.data.cmd.read_length = 0;
+        i2c_slave_set_register_address(0, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.v));
+    }
+}
+
+static void _dimmer_i2c_receive(int length)
 {
-    register_mem.data.address = DIMMER_REGISTER_ADDRESS;
-    register_mem.data.cmd.status = DIMMER_COMMAND_STATUS_OK;
-    register_mem.data.cmd.read_length = 0;
-    // Serial.printf_P(PSTR("+REM=i2c=%u\n"),length);
     while(length-- > 0) {
         auto addr = register_mem.data.address;
         _D(5, debug_printf("I2C addr=%#02x data=%02x left=%d\n", addr, Wire.peek(), length));
@@ -63,18 +237,8 @@ void _dimmer_i2c_on_receive(int length)
         if (addr == DIMMER_REGISTER_ADDRESS) {
             register_mem.data.address--;
             _D(5, debug_printf("I2C set addr=%#02x\n", register_mem.data.address));
-            // legacy version request
-            //
-            // +i2ct=17,8a,02,b9
-            // +i2cr=17,07
-            //
-            // older versions will respond with 2 byte for the version and the rest filled with 0xff
-            if (length == 0 && register_mem.data.address == 0xb9 && register_mem.data.cmd.read_length == 2) {
-                _D(5, debug_printf("I2C version request\n"));
-                register_mem.data.ram.v.version._word = Dimmer::Version::kVersion;
-                register_mem.data.ram.v.info = { Dimmer::Level::max, Dimmer::Channel::kSize, DIMMER_REGISTER_OPTIONS, sizeof(register_mem.data.cfg) };
-                register_mem.data.cmd.read_length = 0;
-                i2c_slave_set_register_address(0, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.v));
+            if (length == 0) {
+                _dimmer_i2c_version_request();
             }
         }
         else if (addr == DIMMER_REGISTER_READ_LENGTH) {
@@ -99,19 +263,88 @@ void _dimmer_i2c_on_receive(int length)
                 case DIMMER_COMMAND_SET_LEVEL:
                     _D(5, debug_printf("I2C set=%d ch=%d\n", register_mem.data.to_level, register_mem.data.channel));
                     #if DIMMER_USE_QUEUE_LEVELS
-                        queues.levels[register_mem.data.channel] = dimmer_scheduled_levels_t(register_mem.data.to_level);
+                        queues.push_level(dimmer_scheduled_levels_t(register_mem.data.channel, register_mem.data.to_level));
                     #else
                         dimmer.set_level(register_mem.data.channel, register_mem.data.to_level);
                     #endif
                     break;
                 case DIMMER_COMMAND_FADE:
-                    _D(5, debug_printf("I2C fade from=%d to=%d ch=%d t=%f\n", register_mem.data.from_level, register_mem.data.to_level, register_mem.data.channel, register_mem.data.time));
-                    #if DIMMER_USE_QUEUE_LEVELS
-                        queues.levels[register_mem.data.channel] = dimmer_scheduled_levels_t(register_mem.data.from_level, register_mem.data.to_level, register_mem.data.time);
-                    #else
-                        dimmer.fade_from_to(register_mem.data.channel, register_mem.data.from_level, register_mem.data.to_level, register_mem.data.time);
-                    #endif
+                    {
+                        // optional byte to select the curve
+                        auto curve = static_cast<Dimmer::FadeCurveType>(Wire_read_uint8_t(length, DIMMER_FADE_CURVE_LINEAR));
+                        _D(5, debug_printf("I2C fade from=%d to=%d ch=%d t=%f curve=%u\n", register_mem.data.from_level, register_mem.data.to_level, register_mem.data.channel, register_mem.data.time, static_cast<uint8_t>(curve)));
+                        #if DIMMER_USE_QUEUE_LEVELS
+                            queues.push_level(dimmer_scheduled_levels_t(register_mem.data.channel, register_mem.data.from_level, register_mem.data.to_level, register_mem.data.time, curve));
+                        #else
+                            dimmer.fade_from_to(register_mem.data.channel, register_mem.data.from_level, register_mem.data.to_level, register_mem.data.time, false, curve);
+                        #endif
+                    }
+                    break;
+                case DIMMER_COMMAND_FADE_CHANNELS:
+                    _dimmer_i2c_fade_channels(length);
                     break;
+                #if DIMMER_HAVE_GROUPS
+                    // DIMMER_COMMAND_SET_GROUP_LEVELS is only accepted with the general call
+                    case DIMMER_COMMAND_WRITE_GROUP:
+                        if (length >= static_cast<int>(sizeof(dimmer_config_group_t))) {
+                            length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&conf.config().group), sizeof(dimmer_config_group_t));
+                            _D(5, debug_printf("I2C write group=%u offset=%u\n", conf.config().group.id, conf.config().group.channel_offset));
+                            conf.scheduleWriteConfig();
+                        }
+                        break;
+                    case DIMMER_COMMAND_READ_GROUP:
+                        register_mem.data.ram.group = conf.config().group;
+                        i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.group));
+                        break;
+                #endif
+
+                #if DIMMER_HAVE_SCENES
+                    case DIMMER_COMMAND_WRITE_SCENE: {
+                            uint8_t scene = Wire_read_uint8_t(length, 0xff);
+                            uint8_t channel = Wire_read_uint8_t(length, 0);
+                            if (scene < DIMMER_SCENE_COUNT) {
+                                auto &channels = conf.config().scenes.scenes[scene];
+                                while(channel < Dimmer::Channel::size() && length >= static_cast<int>(sizeof(channels[0]))) {
+                                    length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&channels[channel++]), sizeof(channels[0]));
+                                }
+                                conf.scheduleWriteConfig();
+                            }
+                        }
+                        break;
+                    case DIMMER_COMMAND_READ_SCENE: {
+                            uint8_t scene = Wire_read_uint8_t(length, 0xff);
+                            uint8_t channel = Wire_read_uint8_t(length, 0);
+                            if (scene < DIMMER_SCENE_COUNT && channel < Dimmer::Channel::size()) {
+                                constexpr uint8_t kMaxCount = sizeof(register_mem.data.ram.scene) / sizeof(register_mem.data.ram.scene[0]);
+                                uint8_t count = std::min<uint8_t>(Dimmer::Channel::size() - channel, kMaxCount);
+                                memcpy(register_mem.data.ram.scene, &conf.config().scenes.scenes[scene][channel], count * sizeof(register_mem.data.ram.scene[0]));
+                                i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, count * sizeof(register_mem.data.ram.scene[0]));
+                            }
+                        }
+                        break;
+                    case DIMMER_COMMAND_RECALL_SCENE: {
+                            uint8_t scene = Wire_read_uint8_t(length, 0xff);
+                            if (scene < DIMMER_SCENE_COUNT) {
+                                _dimmer_i2c_recall_scene(scene);
+                            }
+                        }
+                        break;
+                    case DIMMER_COMMAND_STORE_SCENE: {
+                            // store the current levels with the fading time from DIMMER_REGISTER_TIME
+                            uint8_t scene = Wire_read_uint8_t(length, 0xff);
+                            if (scene < DIMMER_SCENE_COUNT) {
+                                float time = register_mem.data.time;
+                                uint16_t time100 = time > 0 ? std::min<float>(time * 100, 0xffff) : 0;
+                                auto &channels = conf.config().scenes.scenes[scene];
+                                DIMMER_CHANNEL_LOOP(i) {
+                                    channels[i] = { register_mem.data.channels.level[i], time100 };
+                                }
+                                conf.scheduleWriteConfig();
+                            }
+                        }
+                        break;
+                #endif
+
                 case DIMMER_COMMAND_READ_NTC:
                     i2c_slave_set_register_address(length, DIMMER_REGISTER_NTC_TEMP, sizeof(register_mem.data.metrics.ntc_temp));
                     break;
@@ -144,6 +377,70 @@ void _dimmer_i2c_on_receive(int length)
                         break;
                 #endif
 
+                #if ENABLE_ZC_PREDICTION
+                    case DIMMER_COMMAND_READ_ZC_PLL:
+                        ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                            dimmer.zc_pll.get(register_mem.data.ram.zc_pll);
+                        }
+                        i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.zc_pll));
+                        break;
+                #endif
+
+                case DIMMER_COMMAND_READ_ERROR_COUNTERS:
+                    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                        register_mem.data.ram.error_counters = error_counters;
+                    }
+                    i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.error_counters));
+                    break;
+
+                #if HAVE_ISR_STATS
+                    case DIMMER_COMMAND_READ_ISR_STATS: {
+                            uint8_t type = Wire_read_uint8_t(length, 0xff);
+                            uint8_t flags = Wire_read_uint8_t(length, 0);
+                            if (type < static_cast<uint8_t>(Dimmer::IsrType::MAX)) {
+                                auto &stats = Dimmer::isr_stats[type];
+                                if (flags & DIMMER_ISR_STATS_READ_HISTOGRAM) {
+                                    stats.get(register_mem.data.ram.isr_histogram);
+                                    i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.isr_histogram));
+                                }
+                                else {
+                                    stats.get(register_mem.data.ram.isr_stats);
+                                    i2c_slave_set_register_address(length, DIMMER_REGISTER_RAM, sizeof(register_mem.data.ram.isr_stats));
+                                }
+                                if (flags & DIMMER_ISR_STATS_RESET) {
+                                    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                                        stats.reset();
+                                    }
+                                }
+                            }
+                        }
+                        break;
+                #endif
+
+                #if DIMMER_HAVE_EVENT_LOG
+                    case DIMMER_COMMAND_READ_EVENT_LOG:
+                        // all events if the sequence number is omitted
+                        _event_log_sequence = Dimmer::event_log.firstSequence();
+                        if (length >= static_cast<int>(sizeof(_event_log_sequence))) {
+                            length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&_event_log_sequence), sizeof(_event_log_sequence));
+                        }
+                        _event_log_read = true;
+                        break;
+                #endif
+
+                #if DIMMER_HAVE_STATE_VERSION
+                    case DIMMER_COMMAND_READ_CHANGED_CHANNELS: {
+                            // all channels if the version is omitted
+                            uint16_t version = dimmer.state_version + 1;
+                            if (length >= static_cast<int>(sizeof(version))) {
+                                length -= Wire.readBytes(reinterpret_cast<uint8_t *>(&version), sizeof(version));
+                            }
+                            _changed_channels_length = dimmer.get_changed_channels(version, _changed_channels, sizeof(_changed_channels));
+                            _D(5, debug_printf("I2C changed channels since %u len=%u\n", version, _changed_channels_length));
+                        }
+                        break;
+                #endif
+
                 case DIMMER_COMMAND_SET_MODE:
                     if (length-- > 0) {
                         dimmer.set_mode((Wire.read() == 1) ? Dimmer::ModeType::LEADING_EDGE : Dimmer::ModeType::TRAILING_EDGE);
@@ -220,23 +517,27 @@ void _dimmer_i2c_on_receive(int length)
 
                     case DIMMER_COMMAND_INCR_HW_TICKS:
                         dimmer.halfwave_ticks += Wire_read_uint8_t(length, 1);
+                        dimmer.set_channels_dirty();
                         Serial.printf_P(PSTR("+REM=ticks=%d\n"), dimmer.halfwave_ticks);
                         break;
                     case DIMMER_COMMAND_DECR_HW_TICKS:
                         dimmer.halfwave_ticks -= Wire_read_uint8_t(length, 1);
+                        dimmer.set_channels_dirty();
                         Serial.printf_P(PSTR("+REM=ticks=%d\n"), dimmer.halfwave_ticks);
                         break;
 
                     case DIMMER_COMMAND_DUMP_CHANNELS: {
-                            decltype(dimmer.ordered_channels) tmp;
+                            decltype(dimmer.sorted_channels) tmp;
                             decltype(dimmer.levels_buffer) tmp2;
+                            Dimmer::Channel::type count;
                             ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-                                memcpy(tmp, dimmer.ordered_channels, sizeof(tmp));
+                                memcpy(tmp, dimmer.sorted_channels, sizeof(tmp));
                                 memcpy(tmp2, dimmer.levels_buffer, sizeof(tmp2));
+                                count = dimmer.sorted_channels_count;
                             }
                             Serial.print(F("+REM="));
-                            if (tmp[0].ticks) {
-                                for(Dimmer::Channel::type i = 0; tmp[i].ticks; i++) {
+                            if (count) {
+                                for(Dimmer::Channel::type i = 0; i < count; i++) {
                                     Serial.printf_P(PSTR("%u=%u(%u) "), tmp[i].channel, tmp[i].ticks, tmp2[tmp[i].channel]);
                                 }
                                 Serial.println();
@@ -343,27 +644,22 @@ void _dimmer_i2c_on_receive(int length)
                     case DIMMER_COMMAND_WRITE_CUBIC_INT: {
                             uint8_t channel = Wire_read_uint8_t(length, 0xff);
                             if (channel < DIMMER_CHANNEL_COUNT) {
-                                ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
-                                    register_mem.data.ram.cubic_int = {};
-                                    if (length > 0) {
-                                        auto size = std::min<uint8_t>(DIMMER_CUBIC_INT_DATA_POINTS * 2, length);
-                                        _D(5, debug_printf("write_cubic_int %u\n", length));
-                                        if (Wire.readBytes(reinterpret_cast<uint8_t *>(&register_mem.data.ram.cubic_int.points), size) == size) {
-                                            cubicInterpolation.getChannel(channel).createFromConfig(register_mem.data.ram.cubic_int);
-                                        }
-                                    }
-                                    else {
-                                        _D(5, debug_printf("write_cubic_int clear\n"));
-                                        cubicInterpolation.getChannel(channel).createFromConfig(register_mem.data.ram.cubic_int);
-                                    }
-                                    // check if there is any data
-                                    register_mem.data.cfg.bits.cubic_interpolation = false;
-                                    DIMMER_CHANNEL_LOOP(channel) {
-                                        _D(5, debug_printf("write_cubic_int channel=%u size=%u\n"), channel, cubicInterpolation.getChannel(channel).size());
-                                        if (cubicInterpolation.getChannel(channel).size()) {
-                                            register_mem.data.cfg.bits.cubic_interpolation = true;
-                                            break;
-                                        }
+                                // the Wire library calls this handler inside the TWI interrupt. the data points are
+                                // stored and the table is created by cubicInterpolation.update() in loop()
+                                register_mem.data.ram.cubic_int = {};
+                                bool valid = true;
+                                if (length > 0) {
+                                    auto size = std::min<uint8_t>(DIMMER_CUBIC_INT_DATA_POINTS * 2, length);
+                                    _D(5, debug_printf("write_cubic_int %u\n", length));
+                                    valid = Wire.readBytes(reinterpret_cast<uint8_t *>(&register_mem.data.ram.cubic_int.points), size) == size;
+                                }
+                                else {
+                                    _D(5, debug_printf("write_cubic_int clear\n"));
+                                }
+                                if (valid) {
+                                    cubicInterpolation.getChannel(channel).setConfig(register_mem.data.ram.cubic_int);
+                                    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                                        queues.scheduled_calls.update_cubic_int = true;
                                     }
                                 }
                             }
@@ -386,13 +682,107 @@ void _dimmer_i2c_on_receive(int length)
     }
 }
 
+void _dimmer_i2c_on_receive(int length)
+{
+    #if DIMMER_HAVE_GROUPS
+        if (Wire.isGeneralCall()) {
+            _dimmer_i2c_on_general_call(length);
+            return;
+        }
+    #endif
+    #if DIMMER_HAVE_EVENT_LOG
+        _event_log_read = false;
+    #endif
+    #if DIMMER_HAVE_STATE_VERSION
+        _changed_channels_length = 0;
+    #endif
+    register_mem.data.address = DIMMER_REGISTER_ADDRESS;
+    register_mem.data.cmd.status = DIMMER_COMMAND_STATUS_OK;
+    register_mem.data.cmd.read_length = 0;
+    // Serial.printf_P(PSTR("+REM=i2c=%u\n"),length);
+    _dimmer_i2c_receive(length);
+}
+
+#if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+
+static bool _address_written;
+
+// TWI_vect, decodes the register writes while the data is being received. the command register and all
+// following bytes are buffered and executed by _dimmer_i2c_on_receive_buffered()
+static bool _dimmer_i2c_on_receive_byte(uint8_t data, uint8_t index)
+{
+    #if DIMMER_HAVE_GROUPS
+        // the general call is buffered and not written to the registers
+        if (Wire.isGeneralCall()) {
+            return false;
+        }
+    #endif
+    if (index == 0) {
+        #if DIMMER_HAVE_EVENT_LOG
+            _event_log_read = false;
+        #endif
+        #if DIMMER_HAVE_STATE_VERSION
+            _changed_channels_length = 0;
+        #endif
+        register_mem.data.address = DIMMER_REGISTER_ADDRESS;
+        register_mem.data.cmd.status = DIMMER_COMMAND_STATUS_OK;
+        register_mem.data.cmd.read_length = 0;
+    }
+    auto addr = register_mem.data.address;
+    if (addr == DIMMER_REGISTER_COMMAND) {
+        return false;
+    }
+    i2c_write_to_register(data);
+    if (addr == DIMMER_REGISTER_ADDRESS) {
+        register_mem.data.address--;
+    }
+    else if (addr == DIMMER_REGISTER_READ_LENGTH) {
+        register_mem.data.address = DIMMER_REGISTER_ADDRESS;
+    }
+    _address_written = (addr == DIMMER_REGISTER_ADDRESS);
+    return true;
+}
+
+// called after the stop condition with interrupts enabled
+static void _dimmer_i2c_on_receive_buffered(int length)
+{
+    #if DIMMER_HAVE_GROUPS
+        if (Wire.isGeneralCall()) {
+            _dimmer_i2c_on_general_call(length);
+            return;
+        }
+    #endif
+    if (length) {
+        _dimmer_i2c_receive(length);
+    }
+    else if (_address_written) {
+        _dimmer_i2c_version_request();
+    }
+    _address_written = false;
+}
+
+#endif
+
 void _dimmer_i2c_on_request()
 {
+    #if DIMMER_HAVE_EVENT_LOG
+        if (_event_log_read) {
+            Dimmer::event_log.read(_event_log_sequence, DIMMER_EVENT_LOG_READ_SIZE);
+            return;
+        }
+    #endif
+    #if DIMMER_HAVE_STATE_VERSION
+        if (_changed_channels_length) {
+            Wire.write(_changed_channels, _changed_channels_length);
+            return;
+        }
+    #endif
     #if DEBUG
         auto tmp = register_mem.data.cmd.read_length;
     #endif
     Dimmer::RegisterMemory::request data(register_mem.data.address, register_mem.data.cmd.read_length);
     _D(5, debug_printf("I2C on_request addr=%#02x len=%u avail=%u\n", register_mem.data.address, tmp, data.size()));
+    // TwiSlave sends the data directly from the register memory
     Wire.write(data.data(), data.size());
 }
 
@@ -403,6 +793,15 @@ void dimmer_i2c_slave_setup()
     conf.initRegisterMem();
 
     Wire.begin(DIMMER_I2C_ADDRESS);
-    Wire.onReceive(_dimmer_i2c_on_receive);
+    #if DIMMER_HAVE_GROUPS && !SERIAL_I2C_BRIDGE
+        // receive DIMMER_COMMAND_SET_GROUP_LEVELS sent to DIMMER_I2C_GENERAL_CALL_ADDRESS
+        Wire.enableGeneralCall();
+    #endif
+    #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+        Wire.onReceiveByte(_dimmer_i2c_on_receive_byte);
+        Wire.onReceive(_dimmer_i2c_on_receive_buffered);
+    #else
+        Wire.onReceive(_dimmer_i2c_on_receive);
+    #endif
     Wire.onRequest(_dimmer_i2c_on_request);
 }
@@ -52,6 +52,74 @@ inline __attribute_always_inline__ static uint24_t __uint24_from_shr8_ui32(const
     return value >> 8;
 }
 
+#elif DIMMER_NATIVE
+
+// the native environment stores the value in a 24 bit wide bit field to get the same size and overflow as __uint24/__int24
+
+template<typename _Type>
+class __attribute_packed__ int24_bitfield_t
+{
+public:
+    constexpr int24_bitfield_t() : _value(0) {}
+    constexpr int24_bitfield_t(_Type value) : _value(value) {}
+    constexpr int24_bitfield_t(const int24_bitfield_t &value) = default;
+    int24_bitfield_t(const volatile int24_bitfield_t &value) : _value(value._value) {}
+
+    constexpr operator _Type() const {
+        return _value;
+    }
+    operator _Type() const volatile {
+        return _value;
+    }
+
+    int24_bitfield_t &operator=(const int24_bitfield_t &value) = default;
+    int24_bitfield_t &operator=(_Type value) {
+        _value = value;
+        return *this;
+    }
+    void operator=(_Type value) volatile {
+        _value = value;
+    }
+    int24_bitfield_t &operator+=(_Type value) {
+        _value = _value + value;
+        return *this;
+    }
+    int24_bitfield_t &operator-=(_Type value) {
+        _value = _value - value;
+        return *this;
+    }
+    int24_bitfield_t &operator++() {
+        _value = _value + 1;
+        return *this;
+    }
+    _Type operator++(int) {
+        _Type tmp = _value;
+        _value = tmp + 1;
+        return tmp;
+    }
+    _Type operator++(int) volatile {
+        _Type tmp = _value;
+        _value = tmp + 1;
+        return tmp;
+    }
+
+private:
+    _Type _value: 24;
+};
+
+using uint24_t = int24_bitfield_t<uint32_t>;
+using int24_t = int24_bitfield_t<int32_t>;
+
+static_assert(sizeof(uint24_t) == 3 && sizeof(int24_t) == 3, "something went wrong");
+
+inline __attribute_always_inline__ static uint24_t __uint24_from_ui16_ui8(const uint16_t hi, const uint8_t lo) {
+    return lo | static_cast<uint32_t>(static_cast<uint8_t>(hi)) << 16;
+}
+
+inline __attribute_always_inline__ static uint24_t __uint24_from_shr8_ui32(const uint32_t value) {
+    return value >> 8;
+}
+
 #else
 
 class uint24_t;
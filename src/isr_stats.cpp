@@ -0,0 +1,32 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "isr_stats.h"
+
+#if HAVE_ISR_STATS
+
+using namespace Dimmer;
+
+IsrStats Dimmer::isr_stats[static_cast<uint8_t>(IsrType::MAX)];
+
+void IsrStats::get(dimmer_isr_stats_t &stats) const
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats.count = count;
+        stats.min = min;
+        stats.max = max;
+        stats.avg = count ? sum / count : 0;
+        stats.latency_max = latency_max;
+        stats.latency_avg = count ? latency_sum / count : 0;
+    }
+}
+
+void IsrStats::get(dimmer_isr_histogram_t &histogram) const
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        memcpy(histogram.counts, this->histogram, sizeof(histogram.counts));
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+#include <util/atomic.h>
+#include "dimmer_def.h"
+#include "dimmer_protocol.h"
+#include "dimmer_reg_mem.h"
+
+#if HAVE_ISR_STATS
+
+#include "dimmer.h"
+
+extern Dimmer::MeasureTimer timer2;
+
+namespace Dimmer {
+
+    enum class IsrType : uint8_t {
+        COMPARE_A = DIMMER_ISR_STATS_COMPARE_A,
+        COMPARE_B = DIMMER_ISR_STATS_COMPARE_B,
+        ZERO_CROSSING = DIMMER_ISR_STATS_ZC,
+        ADC_COMPLETE = DIMMER_ISR_STATS_ADC,
+        #if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+            // each byte, without processing the data after the stop condition
+            TWI = DIMMER_ISR_STATS_TWI,
+        #endif
+        MAX
+    };
+
+    // duration and latency of an interrupt handler in clock cycles (timer2)
+    //
+    // the duration includes nested interrupts if the handler enables interrupts. the latency is the time
+    // between the compare match and entering the handler
+    struct IsrStats {
+        // bucket n counts durations below kHistogramMinCycles << n, the last bucket all others
+        static constexpr uint8_t kHistogramSize = sizeof(dimmer_isr_histogram_t::counts) / sizeof(dimmer_isr_histogram_t::counts[0]);
+        static constexpr uint16_t kHistogramMinCycles = 64;
+
+        uint32_t sum;
+        uint32_t latency_sum;
+        uint16_t count;
+        uint16_t min;
+        uint16_t max;
+        uint16_t latency_max;
+        uint16_t histogram[kHistogramSize];
+
+        void add(uint32_t duration, uint16_t latency);
+        void reset();
+
+        void get(dimmer_isr_stats_t &stats) const;
+        void get(dimmer_isr_histogram_t &histogram) const;
+    };
+
+    extern IsrStats isr_stats[static_cast<uint8_t>(IsrType::MAX)];
+
+    // stores the time when the handler has been entered and adds it to the statistics when leaving the scope
+    template<IsrType _Type>
+    struct IsrStatsScope {
+        IsrStatsScope(uint16_t latency = 0) : _start(timer2.get_timer()), _latency(latency) {}
+        ~IsrStatsScope() {
+            // the handler might have enabled interrupts
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                isr_stats[static_cast<uint8_t>(_Type)].add(timer2.get_timer() - _start, _latency);
+            }
+        }
+
+        uint32_t _start;
+        uint16_t _latency;
+    };
+
+    inline void IsrStats::add(uint32_t duration, uint16_t latency)
+    {
+        uint16_t cycles = duration > 0xffff ? 0xffff : duration;
+        if (count == 0xffff) {
+            // keep the average of the recent calls
+            count >>= 1;
+            sum >>= 1;
+            latency_sum >>= 1;
+        }
+        if (count++ == 0 || cycles < min) {
+            min = cycles;
+        }
+        if (cycles > max) {
+            max = cycles;
+        }
+        if (latency > latency_max) {
+            latency_max = latency;
+        }
+        sum += cycles;
+        latency_sum += latency;
+
+        uint8_t bucket = 0;
+        for(uint16_t limit = kHistogramMinCycles; cycles >= limit && bucket < kHistogramSize - 1; limit <<= 1) {
+            bucket++;
+        }
+        if (histogram[bucket] != 0xffff) {
+            histogram[bucket]++;
+        }
+    }
+
+    inline void IsrStats::reset()
+    {
+        memset(this, 0, sizeof(*this));
+    }
+
+}
+
+#    define ISR_STATS_SCOPE(type)                          Dimmer::IsrStatsScope<Dimmer::IsrType::type> __isr_stats_scope;
+#    define ISR_STATS_SCOPE_LATENCY(type, latency_cycles)   Dimmer::IsrStatsScope<Dimmer::IsrType::type> __isr_stats_scope(latency_cycles);
+
+#else
+
+#    define ISR_STATS_SCOPE(type)
+#    define ISR_STATS_SCOPE_LATENCY(type, latency_cycles)
+
+#endif
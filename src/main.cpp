@@ -15,6 +15,7 @@
 #include "helpers.h"
 #include "measure_frequency.h"
 #include "adc.h"
+#include "isr_stats.h"
 
 Queues queues;
 
@@ -57,7 +58,36 @@ void display_dimmer_info()
     #if HAVE_FADE_COMPLETION_EVENT
         Serial.print(F("fading_events=1,"));
     #endif
-    #if SERIAL_I2C_BRIDGE
+    #if HAVE_ISR_STATS
+        Serial.print(F("isr_stats=1,"));
+    #endif
+    #if DIMMER_HAVE_GROUPS
+        Serial.printf_P(PSTR("group=%u:%u,"), conf.config().group.id, conf.config().group.channel_offset);
+    #endif
+    #if DIMMER_HAVE_SCENES
+        Serial.printf_P(PSTR("scenes=%u,"), DIMMER_SCENE_COUNT);
+    #endif
+    #if DIMMER_HAVE_EVENT_QUEUE
+        Serial.print(F("event_queue=" _STRINGIFY(DIMMER_EVENT_QUEUE_SIZE) ","));
+    #endif
+    #if DIMMER_HAVE_COMPOUND_EVENTS
+        Serial.print(F("compound_events=1,"));
+    #endif
+    #if DIMMER_HAVE_EVENT_LOG
+        Serial.print(F("event_log=" _STRINGIFY(DIMMER_EVENT_LOG_SIZE) ","));
+    #endif
+    #if DIMMER_HAVE_STATE_VERSION
+        Serial.print(F("state_version=1,"));
+    #endif
+    #if DIMMER_ZC_INPUT_CAPTURE
+        Serial.print(F("zc_capture=1,"));
+    #endif
+    #if DIMMER_ZC_FILTER
+        Serial.print(F("zc_filter=" _STRINGIFY(DIMMER_ZC_FILTER_VALID_EDGES) "/" _STRINGIFY(DIMMER_ZC_FILTER_EDGES) ","));
+    #endif
+    #if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+        Serial.print(F("proto=UART-frames,"));
+    #elif SERIAL_I2C_BRIDGE
         Serial.print(F("proto=UART,"));
     #else
         Serial.print(F("proto=I2C,"));
@@ -136,6 +166,52 @@ void setup()
     _D(5, debug_printf("exiting setup\n"));
 }
 
+void Dimmer::send_event(uint8_t event, const uint8_t *extraByte, const uint8_t *data, uint8_t length)
+{
+    // event id, sequence number and extra byte
+    uint8_t header[4] = { event };
+    uint8_t headerLength = 1;
+
+    // events sent by I2C commands can interrupt loop(). the sequence number must match the order of the events
+    // in the log and the queue
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        #if DIMMER_HAVE_EVENT_LOG
+            uint16_t sequence = event_log.sequence();
+            header[headerLength++] = sequence;
+            header[headerLength++] = sequence >> 8;
+        #endif
+        if (extraByte) {
+            header[headerLength++] = *extraByte;
+        }
+
+        #if DIMMER_HAVE_EVENT_LOG
+            event_log.add(header, headerLength, data, length);
+        #endif
+        #if DIMMER_HAVE_EVENT_QUEUE
+            event_queue.push(header, headerLength, data, length);
+        #endif
+    }
+
+    #if !DIMMER_HAVE_EVENT_QUEUE
+        // Wire cannot start a transmission while it is blocked in endTransmission() for the interrupted one
+        static volatile bool busy;
+        if (busy) {
+            if (error_counters.event_send_busy != 0xff) {
+                error_counters.event_send_busy++;
+            }
+            return;
+        }
+        busy = true;
+
+        Wire.beginTransmission(DIMMER_I2C_MASTER_ADDRESS);
+        Wire.write(header, headerLength);
+        Wire.write(data, length);
+        Wire.endTransmission();
+
+        busy = false;
+    #endif
+}
+
 #if HAVE_FADE_COMPLETION_EVENT
 
     void Dimmer::DimmerBase::send_fading_completion_events()
@@ -178,6 +254,10 @@ void restore_level()
 
 void loop()
 {
+    #if DIMMER_HAVE_EVENT_QUEUE
+        Dimmer::event_queue.loop();
+    #endif
+
     // run in main loop that the I2C slave is responding
     if (measure) {
         if (FrequencyMeasurement::run()) {
@@ -229,29 +309,15 @@ void loop()
     #endif
 
     #if DIMMER_USE_QUEUE_LEVELS
-        // apply level changes that have been received by i2c
-        for(uint8_t i = 0; i < Dimmer::Channel::size(); i++) {
-            #if SERIAL_I2C_BRIDGE
-                // levels are only changed in SerialEvent, once at the end of each main loop
-                auto &level = queues.levels[i];
-            #else
-                cli();
-                auto level = queues.levels[i];
-                queues.levels[i].type = dimmer_scheduled_levels_t::SetType::NONE;
-                sei();
-            #endif
+        // apply level changes that have been received by i2c in the order they have been received
+        dimmer_scheduled_levels_t level;
+        while(queues.levels.pop(level)) {
             switch(level.type) {
                 case dimmer_scheduled_levels_t::SetType::SET:
-                    dimmer.set_channel_level(i, level.to);
-                    #if SERIAL_I2C_BRIDGE
-                        level.type = dimmer_scheduled_levels_t::SetType::NONE;
-                    #endif
+                    dimmer.set_level(level.channel, level.to);
                     break;
                 case dimmer_scheduled_levels_t::SetType::FADE:
-                    dimmer.fade_channel_from_to(i, level.from, level.to, level.time);
-                    #if SERIAL_I2C_BRIDGE
-                        level.type = dimmer_scheduled_levels_t::SetType::NONE;
-                    #endif
+                    dimmer.fade_from_to(level.channel, level.from, level.to, level.time, false, level.curve);
                     break;
                 case dimmer_scheduled_levels_t::SetType::NONE:
                     break;
@@ -360,6 +426,15 @@ void loop()
         }
     #endif
 
+    #if DIMMER_CUBIC_INTERPOLATION
+        if (tmp_scheduled_calls.update_cubic_int) {
+            ATOMIC_BLOCK(ATOMIC_FORCEON) {
+                queues.scheduled_calls.update_cubic_int = false;
+            }
+            cubicInterpolation.update();
+        }
+    #endif
+
     if (tmp_scheduled_calls.write_eeprom && conf.isEEPROMWriteTimerExpired()) {
         conf._writeConfig(false);
     }
@@ -384,7 +459,7 @@ void loop()
             queues.check_temperature.timer = Queues::kTemperatureCheckTimerOverflows;
         }
         #if ENABLE_ZC_PREDICTION
-            dimmer.set_halfwave_ticks(dimmer.halfwave_ticks_integral);
+            dimmer.update_frequency();
         #endif
 
         int16_t current_temp;
@@ -442,6 +517,15 @@ void loop()
             disable_serial_read_during_delay();
             Dimmer::DimmerEvent<DIMMER_EVENT_METRICS_REPORT>::send(static_cast<uint8_t>(current_temp), register_mem.data.metrics);
 
+            #if HAVE_ISR_STATS_EVENT
+                for(uint8_t i = 0; i < static_cast<uint8_t>(Dimmer::IsrType::MAX); i++) {
+                    dimmer_isr_stats_event_t event;
+                    event.type = i;
+                    Dimmer::isr_stats[i].get(event.stats);
+                    Dimmer::DimmerEvent<DIMMER_EVENT_ISR_STATS>::send(event);
+                }
+            #endif
+
             #if DEBUG_ZC_PREDICTION
                 // display the zc prediction values
                 Serial.flush();
@@ -453,11 +537,9 @@ void loop()
                     Serial.print(tmp);
                     Serial.print(',');
                 }
-                Serial.print(dimmer.halfwave_ticks_integral, 1);
-                Serial.print(',');
-                Serial.print(dimmer._get_frequency(), 4);
+                Serial.print(dimmer.zc_pll.period());
                 Serial.print(',');
-                Serial.println((F_CPU / 2) / dimmer.halfwave_ticks_integral, 4);
+                Serial.println(dimmer._get_frequency(), 4);
                 Serial.flush();
             #endif
         }
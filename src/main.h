@@ -7,6 +7,7 @@
 #include <util/atomic.h>
 #include "dimmer.h"
 #include "i2c_slave.h"
+#include "ring_buffer.h"
 
 static_assert(DIMMER_REGISTER_MEM_SIZE + DIMMER_REGISTER_START_ADDR <= 255, "out of memory");
 
@@ -32,6 +33,7 @@ struct dimmer_scheduled_calls_templ_t {
             type send_channel_state: 1;
             type send_fading_events: 1;
             type sync_event: 1;
+            type update_cubic_int: 1;
         };
         uint8_t _data;
     };
@@ -58,13 +60,15 @@ struct dimmer_scheduled_levels_t {
     };
 
     SetType type;
+    Dimmer::Channel::type channel;
     int16_t from;
     int16_t to;
     float time;
+    Dimmer::FadeCurveType curve;
 
-    dimmer_scheduled_levels_t() : type(SetType::NONE), from(0), to(0), time(NAN) {}
-    dimmer_scheduled_levels_t(int16_t level) : type(SetType::SET), from(0), to(level), time(NAN) {}
-    dimmer_scheduled_levels_t(int16_t _from, uint16_t _to, float _time) : type(SetType::FADE), from(_from), to(_to), time(_time) {}
+    dimmer_scheduled_levels_t() : type(SetType::NONE), channel(0), from(0), to(0), time(NAN), curve(Dimmer::FadeCurveType::LINEAR) {}
+    dimmer_scheduled_levels_t(Dimmer::Channel::type _channel, int16_t level) : type(SetType::SET), channel(_channel), from(0), to(level), time(NAN), curve(Dimmer::FadeCurveType::LINEAR) {}
+    dimmer_scheduled_levels_t(Dimmer::Channel::type _channel, int16_t _from, uint16_t _to, float _time, Dimmer::FadeCurveType _curve) : type(SetType::FADE), channel(_channel), from(_from), to(_to), time(_time), curve(_curve) {}
 };
 
 struct Queues {
@@ -105,7 +109,15 @@ struct Queues {
 
     dimmer_scheduled_calls_t scheduled_calls{0};
     #if DIMMER_USE_QUEUE_LEVELS
-        dimmer_scheduled_levels_t levels[Dimmer::Channel::size()];
+        // commands from _dimmer_i2c_on_receive() to loop()
+        Dimmer::RingBuffer<dimmer_scheduled_levels_t, DIMMER_LEVEL_QUEUE_SIZE> levels;
+
+        // called by the producer only, counts dropped commands in error_counters.level_queue_overflow
+        void push_level(const dimmer_scheduled_levels_t &level) {
+            if (!levels.push(level) && error_counters.level_queue_overflow != 0xff) {
+                error_counters.level_queue_overflow++;
+            }
+        }
     #endif
 };
 
@@ -5,13 +5,22 @@
 #include "measure_frequency.h"
 #include "adc.h"
 #include <avr/io.h>
+#include <util/atomic.h>
 
 // measure the interval between the zero crossing events
 //
-// first stage filter is 48-62Hz, DIMMER_ZC_MIN_VALID_SAMPLES valid results must be present
+// each interval is filtered when the edge is received. the first stage filter is 48-62Hz. the first interval that
+// passes sets the reference and the second stage filter removes intervals that are more than
+// DIMMER_ZC_INTERVAL_MAX_DEVIATION off the running mean. the sum and the sum of squares of the valid intervals
+// are kept relative to the reference, which fits into 32 bit integers
 //
-// second state filter is to compare all results and generate an average. values that are +-0.75% are removed.
-// DIMMER_ZC_MIN_VALID_SAMPLES valid values must be present here as well to calculate the frequency
+// if more intervals are rejected in a row than have been accepted, the reference was most likely a spurious edge
+// and the next interval that passes the first stage becomes the new reference
+//
+// the main loop checks the running state and locks once the standard error of the mean is low enough
+// (DIMMER_ZC_LOCK_MIN_SAMPLES, DIMMER_ZC_LOCK_MAX_ERROR_US). otherwise the measurement ends after DIMMER_ZC_MIN_SAMPLES
+// intervals and requires DIMMER_ZC_MIN_VALID_SAMPLES valid ones. the mean length of the half wave is passed to the
+// dimmer as fixed point integer
 //
 // this makes sure all zc events that are received are within the range of the initial measurement over many cycles (DIMMER_ZC_INTERVAL_MAX_DEVIATION)
 // if too many invalid signals are received, the dimmer is stopped (DIMMER_OUT_OF_SYNC_LIMIT) and a new frequency measurement started
@@ -24,101 +33,103 @@ ISR(TIMER1_OVF_vect)
     timer1_overflow++;
 }
 
-void FrequencyMeasurement::calc_min_max()
+float FrequencyMeasurement::Stats::variance() const
 {
-    uint24_t _min;
-    uint24_t _max;
-    #if DEBUG_FREQUENCY_MEASUREMENT
-        uint8_t stage1 = 0;
-        uint8_t stage2 = 0;
-        int16_t count = _count;
-    #endif
-
-    _frequency = 0;
-
-    // stage 0
-
-    _D(5, debug_printf("frequency errors=%u,zc=%u\n", _errors, _count));
-    if (_count-- > DIMMER_ZC_MIN_VALID_SAMPLES) {
-
-        // stage 1
-
-        uint32_t sum = 0;
-        uint8_t num = 0;
-        for(int i = 0; i < _count; i++) {
-            auto diff = _ticks[i + 1].diff(_ticks[i]);
-            if (diff >= Dimmer::kMinCyclesPerHalfWave && diff <= Dimmer::kMaxCyclesPerHalfWave) { // filter between 48 and 62Hz
-                sum += diff;
-                num++;
-            }
-        }
-        #if DEBUG_FREQUENCY_MEASUREMENT
-            stage1 = num;
-        #endif
+    if (valid < 2) {
+        return INFINITY;
+    }
+    float mean = sum / static_cast<float>(valid);
+    return (sum_squares - sum * mean) / (valid - 1);
+}
 
-        if (num > DIMMER_ZC_MIN_VALID_SAMPLES) {
-
-            // stage 2
-
-            _calc_halfwave_min_max(sum / num, _min, _max);
-
-            #if DEBUG_FREQUENCY_MEASUREMENT
-                sei();
-            #endif
-
-            // filter again with new min/max
-            sum = 0;
-            num = 0;
-            for(int i = 0; i < _count; i++) {
-                auto diff = _ticks[i + 1].diff(_ticks[i]);
-                #if DEBUG_FREQUENCY_MEASUREMENT
-                    char ch = '-';
-                #endif
-                if (diff >= _min && diff <= _max) {
-                    sum += diff;
-                    num++;
-                    #if DEBUG_FREQUENCY_MEASUREMENT
-                        ch = '+';
-                    #endif
-                }
-                #if DEBUG_FREQUENCY_MEASUREMENT
-                    Serial.printf_P(PSTR("+REM=%lu%c\n"), (long)diff, ch);
-                    Serial.flush();
-                #endif
-            }
-            #if DEBUG_FREQUENCY_MEASUREMENT
-                stage2 = num;
-            #endif
-
-            if (num > DIMMER_ZC_MIN_VALID_SAMPLES) {
-                auto ticks = (sum / static_cast<float>(num));
-                _frequency = 500000.0 / clockCyclesToMicroseconds(ticks);
-                #if DEBUG_FREQUENCY_MEASUREMENT
-                    Serial.printf_P(PSTR("+REM=f-sync=%f,c=%u,s1=%u,s2=%u,mi=%lu,ma=%lu\n"), _frequency, count, stage1, stage2, (long)_min, (long)_max);
-                #endif
+inline void FrequencyMeasurement::_add(uint24_t diff)
+{
+    if (diff < Dimmer::kMinCyclesPerHalfWave || diff > Dimmer::kMaxCyclesPerHalfWave) { // filter between 48 and 62Hz
+        _errors++;
+        return;
+    }
+    if (_stats.valid) {
+        if (diff < _min || diff > _max) {
+            _errors++;
+            if (++_rejected <= _stats.valid) {
                 return;
-            } 
+            }
+            // start again with this interval as reference
+            _stats = {};
         }
     }
-    #if DEBUG_FREQUENCY_MEASUREMENT
-        Serial.printf_P(PSTR("+REM=f-sync failed,c=%u,s1=%u,s2=%u,mi=%lu,ma=%lu\n"), count, stage1, stage2, (long)_min, (long)_max);
-    #endif
+    if (!_stats.valid) {
+        _stats.ref = diff;
+    }
+    int16_t delta = static_cast<int32_t>(diff) - static_cast<int32_t>(_stats.ref);
+    _stats.sum += delta;
+    _stats.sum_squares += static_cast<int32_t>(delta) * delta;
+    _stats.valid++;
+    _rejected = 0;
+    // the mean only changes with a valid sample
+    _calc_halfwave_min_max(_stats.ref + static_cast<int16_t>(_stats.sum / _stats.valid), _min, _max);
 }
 
 void FrequencyMeasurement::zc_measure_handler(uint16_t lo, uint16_t hi)
 {
-    if (_count < 0) { // warm up run
-        _count++;
+    uint24_t ticks = lo | (uint24_t)hi << 16;
+    if (_count++ <= 0) { // warm up run, the last edge starts the first interval
+        _last = ticks;
         return;
     }
-    _ticks[_count++] = lo | (uint24_t)hi << 16;
-    if (_count == kMeasurementBufferSize) {
-        // detach handler and do calculations
+    _add(ticks - _last);
+    _last = ticks;
+    if (_count > kMaxSamples) {
+        // all samples collected
         FrequencyMeasurement::detach_handler();
-        calc_min_max();
     }
 }
 
+inline bool FrequencyMeasurement::_isLocked(const Stats &stats, uint8_t count) const
+{
+    #if DIMMER_ZC_LOCK_MIN_SAMPLES
+        static constexpr float kMaxError = microsecondsToClockCycles(DIMMER_ZC_LOCK_MAX_ERROR_US);
+        // same ratio of valid samples as DIMMER_ZC_MIN_VALID_SAMPLES
+        if (stats.valid < DIMMER_ZC_LOCK_MIN_SAMPLES || static_cast<uint16_t>(stats.valid) * kMaxSamples < static_cast<uint16_t>(count) * DIMMER_ZC_MIN_VALID_SAMPLES) {
+            return false;
+        }
+        // standard error of the mean
+        return stats.variance() <= kMaxError * kMaxError * stats.valid;
+    #else
+        return false;
+    #endif
+}
+
+bool FrequencyMeasurement::is_done()
+{
+    if (_done) {
+        return true;
+    }
+    Stats stats;
+    int16_t count;
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        stats = _stats;
+        count = _count;
+    }
+    if (count > kMaxSamples) {
+        _done = true;
+        if (stats.valid > DIMMER_ZC_MIN_VALID_SAMPLES) {
+            _halfwave = stats.halfwave();
+        }
+    }
+    else if (_isLocked(stats, count)) {
+        _done = true;
+        _halfwave = stats.halfwave();
+    }
+    if (_done) {
+        #if DEBUG_FREQUENCY_MEASUREMENT
+            Serial.printf_P(PSTR("+REM=f-sync=%s,c=%d,v=%u,e=%u,hw=%lu,sd=%.2f\n"), _halfwave ? "ok" : "failed", count, stats.valid, _errors, (unsigned long)(_halfwave >> kFractionBits), sqrt(stats.variance()));
+        #endif
+        _D(5, debug_printf("frequency errors=%u,zc=%d,valid=%u\n", _errors, count, stats.valid));
+    }
+    return _done;
+}
+
 static inline void zc_intr_measure_handler()
 {
     uint16_t counter = TCNT1;
@@ -129,13 +140,34 @@ static inline void zc_intr_measure_handler()
     measure->zc_measure_handler(counter, timer1_overflow);
 }
 
+#if DIMMER_ZC_INPUT_CAPTURE
+
+    static void zc_capture_measure_handler()
+    {
+        uint16_t counter = ICR1;
+        // the overflow happened before the capture if the counter is low
+        if ((TIFR1 & _BV(TOV1)) && counter < 0x8000) {
+            timer1_overflow++;
+            TIFR1 |= _BV(TOV1);
+        }
+        measure->zc_measure_handler(counter, timer1_overflow);
+    }
+
+#endif
+
+// the timer must be running
 void FrequencyMeasurement::attach_handler() 
 {
-    #if digitalPinToInterrupt(ZC_SIGNAL_PIN) == -1
-        // check if the pin supports external interrupts
-        #error ZC_SIGNAL_PIN not supported
+    #if DIMMER_ZC_INPUT_CAPTURE
+        Dimmer::zc_capture_handler = zc_capture_measure_handler;
+        Dimmer::FrequencyTimer::capture_begin<Dimmer::kZCCaptureMode>();
+    #else
+        #if digitalPinToInterrupt(ZC_SIGNAL_PIN) == -1
+            // check if the pin supports external interrupts
+            #error ZC_SIGNAL_PIN not supported
+        #endif
+        attachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN), zc_intr_measure_handler, DIMMER_ZC_INTERRUPT_MODE);
     #endif
-    attachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN), zc_intr_measure_handler, DIMMER_ZC_INTERRUPT_MODE);
 }
 
 void FrequencyMeasurement::cleanup()
@@ -164,8 +196,8 @@ bool FrequencyMeasurement::run()
         measure = new FrequencyMeasurement();
         if (measure) {
             cli();
-            measure->attach_handler();            
             Dimmer::FrequencyTimer::begin();
+            measure->attach_handler();
             sei();
         }
         return false;
@@ -173,14 +205,14 @@ bool FrequencyMeasurement::run()
 
     if (measure->is_done()) {
         _D(5, debug_printf("measurement done\n"));
-        dimmer.set_frequency(measure->get_frequency());
+        dimmer.set_halfwave(measure->get_halfwave());
         cleanup();
         return true;
     }
 
     if (measure->is_timeout()) {
         _D(5, debug_printf("timeout during measuring\n"));
-        dimmer.set_frequency(NAN);
+        dimmer.set_halfwave(0);
         cleanup();
         return true;
     }
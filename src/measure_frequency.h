@@ -14,34 +14,41 @@ extern volatile overflow_counter_t timer1_overflow;
 
 class FrequencyMeasurement {
 public:
-    static constexpr uint8_t kMeasurementBufferSize = DIMMER_ZC_MIN_SAMPLES; // number of samples to collect
-    static constexpr uint16_t kTimeoutMillis = (static_cast<uint32_t>(kMeasurementBufferSize) * Dimmer::kMaxMicrosPerHalfWave) * 1.5 / 1000;
+    static constexpr uint8_t kMaxSamples = DIMMER_ZC_MIN_SAMPLES; // max. number of samples to collect
+    static constexpr uint16_t kTimeoutMillis = (static_cast<uint32_t>(kMaxSamples) * Dimmer::kMaxMicrosPerHalfWave) * 1.5 / 1000;
     static constexpr size_t kMaxCycles_uint24 = (1UL << 24) / Dimmer::kMaxCyclesPerHalfWave;
+    // the length of the half wave has 8 bit fraction
+    static constexpr uint8_t kFractionBits = 8;
+    // DIMMER_ZC_INTERVAL_MAX_DEVIATION as 16 bit fraction, the limits are calculated in the ZC interrupt
+    static constexpr uint16_t kMaxDeviation = DIMMER_ZC_INTERVAL_MAX_DEVIATION * 65536.0 + 0.5;
+
+    static_assert(static_cast<uint64_t>(Dimmer::kMaxCyclesPerHalfWave) * kMaxDeviation <= UINT32_MAX, "ticks * kMaxDeviation overflows");
 
     static_assert(kTimeoutMillis > 500, "timeout should not be less than 500ms");
     static_assert(kTimeoutMillis < 5000, "timeout should not exceed 5 seconds");
 
-    class Ticks {
-    public:
-        Ticks() : _value(0) {}
-        Ticks(uint24_t value) : _value(value) {}
-        uint24_t diff(uint24_t value) const {
-            return _value - value;
-        }
-        operator uint24_t() const {
-            return _value;
-        }
-        Ticks &operator=(uint24_t value) {
-            _value = value;
-            return *this;
+    // running sum of the valid samples relative to the first valid sample
+    struct Stats {
+        uint24_t ref;
+        int32_t sum;
+        uint32_t sum_squares;
+        uint8_t valid;
+
+        // mean length of the half wave in clock cycles, fixed point
+        uint32_t halfwave() const {
+            return (static_cast<uint32_t>(ref) << kFractionBits) + ((sum << kFractionBits) / static_cast<int32_t>(valid));
         }
-    private:
-        uint24_t _value;
+
+        // variance of the samples in clock cycles squared
+        float variance() const;
     };
 
     FrequencyMeasurement() : 
-        _frequency(NAN), 
-        _errors(0), 
+        _halfwave(0),
+        _done(false),
+        _stats(),
+        _errors(0),
+        _rejected(0),
         _count(-5),
         _start(millis())
     {}
@@ -49,8 +56,10 @@ public:
     void zc_measure_handler(uint16_t lo, uint16_t hi);
 
     bool is_timeout() const;
-    inline bool is_done() const;
-    float get_frequency() const;
+    // returns true if the measurement has locked or all samples have been collected
+    bool is_done();
+    // length of the half wave in clock cycles with kFractionBits, 0 if the measurement has failed
+    uint32_t get_halfwave() const;
 
     static void attach_handler();
     static void detach_handler();
@@ -60,15 +69,22 @@ public:
     static void _calc_halfwave_min_max(uint24_t ticks, uint24_t &hMin, uint24_t &hMax);
 
 private:
-    void calc_min_max();
+    void _add(uint24_t diff);
+    bool _isLocked(const Stats &stats, uint8_t count) const;
 
 private:
-public:
-    float _frequency;
+    uint32_t _halfwave;
+    bool _done;
+    Stats _stats;
     uint16_t _errors;
+    // consecutive rejected samples
+    uint8_t _rejected;
     int16_t _count;
     uint16_t _start;
-    Ticks _ticks[kMeasurementBufferSize];
+    uint24_t _last;
+    // limits of the second stage filter, updated with the mean of the valid samples
+    uint24_t _min;
+    uint24_t _max;
 };
 
 extern FrequencyMeasurement *measure;
@@ -78,25 +94,24 @@ inline bool FrequencyMeasurement::is_timeout() const
     return (static_cast<uint16_t>(millis()) - _start) > kTimeoutMillis;
 }
 
-inline bool FrequencyMeasurement::is_done() const
-{
-    return !isnan(_frequency);
-}
-
-inline float FrequencyMeasurement::get_frequency() const 
+inline uint32_t FrequencyMeasurement::get_halfwave() const 
 {
-    return _frequency == 0 ? NAN : _frequency;
+    return _halfwave;
 }
 
 inline void FrequencyMeasurement::detach_handler() 
 {
-    detachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN));
+    #if DIMMER_ZC_INPUT_CAPTURE
+        Dimmer::FrequencyTimer::capture_end();
+    #else
+        detachInterrupt(digitalPinToInterrupt(ZC_SIGNAL_PIN));
+    #endif
 }
 
 inline void FrequencyMeasurement::_calc_halfwave_min_max(uint24_t ticks, uint24_t &hMin, uint24_t &hMax)
 {
     // allow up to DIMMER_ZC_INTERVAL_MAX_DEVIATION % deviation from the filtered avg. value
-    uint16_t limit = ticks * DIMMER_ZC_INTERVAL_MAX_DEVIATION;
+    uint16_t limit = (static_cast<uint32_t>(ticks) * kMaxDeviation) >> 16;
     hMin = ticks - limit;
     hMax = ticks + limit;
 }
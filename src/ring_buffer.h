@@ -0,0 +1,64 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+namespace Dimmer {
+
+    // single producer, single consumer queue without disabling interrupts
+    //
+    // the producer only writes _head and the consumer only writes _tail. both are 8 bit, which can be
+    // read and written atomically. one element is kept free to tell a full queue from an empty one
+    template<typename _Type, uint8_t _Size>
+    class RingBuffer {
+    public:
+        static_assert(_Size >= 2 && _Size <= 128 && (_Size & (_Size - 1)) == 0, "size must be a power of 2");
+
+        static constexpr uint8_t kMask = _Size - 1;
+
+        // producer, returns false if the queue is full
+        bool push(const _Type &item) {
+            uint8_t head = _head;
+            uint8_t next = (head + 1) & kMask;
+            if (next == _tail) {
+                return false;
+            }
+            _items[head] = item;
+            // the item must be stored before it is published
+            __asm__ __volatile__ ("" ::: "memory");
+            _head = next;
+            return true;
+        }
+
+        // consumer, returns false if the queue is empty
+        bool pop(_Type &item) {
+            uint8_t tail = _tail;
+            if (tail == _head) {
+                return false;
+            }
+            item = _items[tail];
+            __asm__ __volatile__ ("" ::: "memory");
+            _tail = (tail + 1) & kMask;
+            return true;
+        }
+
+        bool empty() const {
+            return _head == _tail;
+        }
+
+        // interrupts must be disabled
+        void clear() {
+            _head = 0;
+            _tail = 0;
+        }
+
+    private:
+        _Type _items[_Size];
+        volatile uint8_t _head{0};
+        volatile uint8_t _tail{0};
+    };
+
+}
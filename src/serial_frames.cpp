@@ -0,0 +1,149 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if SERIAL_I2C_BRIDGE && DIMMER_SERIAL_BINARY_FRAMES
+
+#include <crc16.h>
+#include "dimmer_protocol.h"
+#include "serial_frames.h"
+
+SerialFrameTwoWire Wire;
+
+void serialEvent()
+{
+    Wire._serialEvent();
+}
+
+void SerialFrameTwoWire::beginTransmission(uint8_t address)
+{
+    _txAddress = address;
+    _txLength = 0;
+}
+
+uint8_t SerialFrameTwoWire::endTransmission(uint8_t)
+{
+    _sendFrame(DIMMER_FRAME_TYPE_TRANSMIT, _txAddress, _txBuffer, _txLength);
+    _txLength = 0;
+    return 0;
+}
+
+size_t SerialFrameTwoWire::write(uint8_t data)
+{
+    if (_txLength >= kBufferLength) {
+        return 0;
+    }
+    _txBuffer[_txLength++] = data;
+    return 1;
+}
+
+size_t SerialFrameTwoWire::write(const uint8_t *buffer, size_t size)
+{
+    if (_request && _txLength == 0) {
+        // send directly from the buffer
+        _txPtr = buffer;
+        _txLength = size > 0xff ? 0xff : size;
+        return size;
+    }
+    size_t written = 0;
+    while (size-- && write(*buffer++)) {
+        written++;
+    }
+    return written;
+}
+
+void SerialFrameTwoWire::_serialEvent()
+{
+    while (Serial.available()) {
+        uint8_t data = Serial.read();
+        switch(_state) {
+            case State::START:
+                if (data == DIMMER_FRAME_START) {
+                    _state = State::LENGTH;
+                }
+                break;
+            case State::LENGTH:
+                if (data == 0 || data > kBufferLength) {
+                    _state = State::START;
+                    break;
+                }
+                _rxLength = data;
+                _rxIndex = 0;
+                _crc = crc16_update(~0, data);
+                _state = State::TYPE;
+                break;
+            case State::TYPE:
+                _type = data;
+                _crc = crc16_update(_crc, data);
+                _state = State::PAYLOAD;
+                break;
+            case State::PAYLOAD:
+                _rxBuffer[_rxIndex++] = data;
+                _crc = crc16_update(_crc, data);
+                if (_rxIndex == _rxLength) {
+                    _state = State::CRC_LOW;
+                }
+                break;
+            case State::CRC_LOW:
+                _crc ^= data;
+                _state = State::CRC_HIGH;
+                break;
+            case State::CRC_HIGH:
+                _state = State::START;
+                if (_crc == (data << 8)) {
+                    _processFrame();
+                }
+                _rxLength = 0;
+                _rxIndex = 0;
+                break;
+        }
+    }
+}
+
+void SerialFrameTwoWire::_processFrame()
+{
+    uint8_t address = _rxBuffer[0];
+    switch(_type) {
+        case DIMMER_FRAME_TYPE_TRANSMIT:
+            #if DIMMER_HAVE_GROUPS
+                _generalCall = (address == DIMMER_I2C_GENERAL_CALL_ADDRESS);
+                if (_generalCall) {
+                    address = _address;
+                }
+            #endif
+            if (address == _address && _onReceive) {
+                _rxIndex = 1;
+                _onReceive(_rxLength - 1);
+            }
+            break;
+        case DIMMER_FRAME_TYPE_REQUEST:
+            if (address == _address && _rxLength >= 2 && _onRequest) {
+                uint8_t length = _rxBuffer[1];
+                _request = true;
+                _txPtr = _txBuffer;
+                _txLength = 0;
+                _onRequest();
+                _request = false;
+                _sendFrame(DIMMER_FRAME_TYPE_RESPONSE, address, _txPtr, _txLength < length ? _txLength : length);
+                _txLength = 0;
+            }
+            break;
+    }
+}
+
+void SerialFrameTwoWire::_sendFrame(uint8_t type, uint8_t address, const uint8_t *data, uint8_t length)
+{
+    if (length > 0xfe) {
+        length = 0xfe;
+    }
+    uint8_t header[] = { DIMMER_FRAME_START, static_cast<uint8_t>(length + 1), type, address };
+    uint16_t crc = crc16_update(~0, &header[1], sizeof(header) - 1);
+    crc = crc16_update(crc, data, length);
+    Serial.write(header, sizeof(header));
+    Serial.write(data, length);
+    Serial.write(reinterpret_cast<const uint8_t *>(&crc), sizeof(crc));
+}
+
+#endif
@@ -0,0 +1,107 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// drop-in replacement for SerialTwoWire that uses binary frames (DIMMER_SERIAL_BINARY_FRAMES)
+//
+// each transaction is sent as one frame instead of a line of hex values. the frame starts with
+// DIMMER_FRAME_START, followed by the length of the payload, the type, the payload and the CRC16 of
+// length, type and payload:
+//
+// +I2CT=17,89,22           02 03 01 17 89 22 xx xx
+// +I2CR=17,02              02 02 02 17 02 xx xx
+//                          02 03 03 17 xx xx xx xx     response
+//
+// bytes outside a frame and frames with an invalid length or CRC are discarded. text that is printed to
+// the serial port (+REM=...) is not framed and must be skipped by the receiver
+
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef DIMMER_SERIAL_FRAME_BUFFER_LENGTH
+#    define DIMMER_SERIAL_FRAME_BUFFER_LENGTH 48
+#endif
+
+class SerialFrameTwoWire : public Stream {
+public:
+    using onReceiveCallback = void (*)(int);
+    using onRequestCallback = void (*)();
+
+    static constexpr uint8_t kBufferLength = DIMMER_SERIAL_FRAME_BUFFER_LENGTH;
+    // DIMMER_FRAME_START, length, type and crc16
+    static constexpr uint8_t kFrameOverhead = 5;
+
+    enum class State : uint8_t {
+        START,
+        LENGTH,
+        TYPE,
+        PAYLOAD,
+        CRC_LOW,
+        CRC_HIGH,
+    };
+
+    void begin() {}
+    void begin(uint8_t address) {
+        _address = address;
+    }
+    void end() {}
+
+    void onReceive(onReceiveCallback callback) {
+        _onReceive = callback;
+    }
+    void onRequest(onRequestCallback callback) {
+        _onRequest = callback;
+    }
+
+    // inside onReceive(), true if the frame has been sent to the general call address
+    bool isGeneralCall() const {
+        return _generalCall;
+    }
+
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(uint8_t sendStop = true);
+
+    // inside the onRequest() callback, the data is sent directly from the buffer
+    using Print::write;
+    virtual size_t write(uint8_t data) override;
+    virtual size_t write(const uint8_t *buffer, size_t size) override;
+
+    virtual int available() override {
+        return _rxLength - _rxIndex;
+    }
+    virtual int read() override {
+        return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+    }
+    virtual int peek() override {
+        return _rxIndex < _rxLength ? _rxBuffer[_rxIndex] : -1;
+    }
+
+    // read the serial port and process complete frames, called by serialEvent()
+    void _serialEvent();
+
+private:
+    void _processFrame();
+    void _sendFrame(uint8_t type, uint8_t address, const uint8_t *data, uint8_t length);
+
+private:
+    onReceiveCallback _onReceive{nullptr};
+    onRequestCallback _onRequest{nullptr};
+    uint8_t _address{0};
+    State _state{State::START};
+    uint8_t _type;
+    uint16_t _crc;
+    // payload of the received frame. the first byte is the slave address
+    uint8_t _rxBuffer[kBufferLength];
+    uint8_t _rxLength{0};
+    uint8_t _rxIndex{0};
+    bool _generalCall{false};
+    uint8_t _txBuffer[kBufferLength];
+    uint8_t _txLength{0};
+    uint8_t _txAddress{0};
+    // onRequest()
+    bool _request{false};
+    const uint8_t *_txPtr{nullptr};
+};
+
+extern SerialFrameTwoWire Wire;
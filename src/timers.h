@@ -156,6 +156,24 @@ namespace Timers {
             TCCR1B = 0;
         }
 
+        static constexpr uint8_t kCaptureFalling = 0;
+        static constexpr uint8_t kCaptureRising = _BV(ICES1);
+        // 4 equal samples are required, which delays the capture by 4 clock cycles
+        static constexpr uint8_t kCaptureNoiseCanceler = _BV(ICNC1);
+
+        // enable the input capture interrupt on ICP1. begin() clears the edge select and the noise canceler
+        template<uint8_t _Mode>
+        static inline void capture_begin() {
+            TCCR1B = (TCCR1B & ~(kCaptureRising|kCaptureNoiseCanceler)) | _Mode;
+            // changing the edge can set the flag
+            clear_flags<kFlagsCapture>();
+            int_mask_enable<kIntMaskCapture>();
+        }
+
+        static inline void capture_end() {
+            int_mask_disable<kIntMaskCapture>();
+        }
+
         static inline uint32_t microsToTicks32(uint32_t micros) {
             return micros * ticksPerMicrosecond;
         }
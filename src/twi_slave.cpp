@@ -0,0 +1,278 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if DIMMER_HAVE_TWI_SLAVE && !SERIAL_I2C_BRIDGE
+
+#include <avr/interrupt.h>
+#include <util/atomic.h>
+#include <util/twi.h>
+#include "twi_slave.h"
+#include "isr_stats.h"
+
+TwiSlave Wire;
+
+ISR(TWI_vect)
+{
+    if (Wire._isr()) {
+        Wire._receive();
+    }
+}
+
+void TwiSlave::begin(uint8_t address)
+{
+    // internal pullups
+    digitalWrite(SDA, HIGH);
+    digitalWrite(SCL, HIGH);
+
+    TWSR &= ~(_BV(TWPS0) | _BV(TWPS1));
+    TWBR = ((F_CPU / DIMMER_TWI_FREQUENCY) - 16) / 2;
+    TWAR = address << 1;
+    _state = State::IDLE;
+    TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
+}
+
+void TwiSlave::end()
+{
+    TWCR &= ~(_BV(TWEN) | _BV(TWIE) | _BV(TWEA));
+}
+
+void TwiSlave::beginTransmission(uint8_t address)
+{
+    _address = address;
+    _txLength = 0;
+}
+
+// a repeated start is not supported, the transmission always ends with a stop condition
+uint8_t TwiSlave::endTransmission(uint8_t)
+{
+    // wait until the current slave transaction has been completed, ~10ms
+    for(uint8_t timeout = 250; !transmit(_address, _txBuffer, _txLength); timeout--) {
+        if (!timeout) {
+            _txLength = 0;
+            return 4;
+        }
+        delayMicroseconds(40);
+    }
+
+    // 32 byte take ~3ms at 100kHz, the slave can stretch the clock
+    uint8_t result;
+    for(uint16_t timeout = 1000; (result = _txResult) == kTransmitBusy; timeout--) {
+        if (!timeout) {
+            ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+                _stop(4);
+            }
+            break;
+        }
+        delayMicroseconds(40);
+    }
+    _txLength = 0;
+    return result == kTransmitBusy ? 4 : result;
+}
+
+bool TwiSlave::transmit(uint8_t address, const uint8_t *buffer, uint8_t length)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+        // TWINT might be set before the interrupt has been executed or the stop condition has not been sent yet
+        if (_state != State::IDLE || (TWCR & (_BV(TWINT) | _BV(TWSTO)))) {
+            return false;
+        }
+        _state = State::MASTER_TX;
+        _address = address;
+        _txPtr = buffer;
+        _txRemaining = length;
+        _txResult = kTransmitBusy;
+        // the start condition is sent when the bus is free. the slave stays enabled and the transmission fails
+        // if it is addressed before
+        TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWSTA) | _BV(TWINT);
+    }
+    return true;
+}
+
+size_t TwiSlave::write(uint8_t data)
+{
+    if (_request) {
+        // single bytes are copied into the buffer
+        if (_txPtr != _txBuffer) {
+            _txPtr = _txBuffer;
+            _txRemaining = 0;
+        }
+        if (_txRemaining >= kBufferLength) {
+            return 0;
+        }
+        _txBuffer[_txRemaining++] = data;
+        return 1;
+    }
+    if (_txLength >= kBufferLength) {
+        return 0;
+    }
+    _txBuffer[_txLength++] = data;
+    return 1;
+}
+
+size_t TwiSlave::write(const uint8_t *buffer, size_t size)
+{
+    if (_request) {
+        // send directly from the buffer
+        _txPtr = buffer;
+        _txRemaining = size;
+        return size;
+    }
+    size_t written = 0;
+    while (size-- && write(*buffer++)) {
+        written++;
+    }
+    return written;
+}
+
+inline void TwiSlave::_reply(bool ack)
+{
+    TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWINT) | (ack ? _BV(TWEA) : 0);
+}
+
+void TwiSlave::_receive()
+{
+    // TWIE is cleared and the state is SLAVE_RX until the data has been processed. the TWI acknowledges
+    // its address and holds SCL low until the interrupt is enabled again
+    sei();
+    _rxIndex = 0;
+    if (_onReceive) {
+        _onReceive(_rxLength);
+    }
+    _rxLength = 0;
+    _rxIndex = 0;
+    cli();
+    _state = State::IDLE;
+    // TWINT is not cleared, a pending address match is handled after returning from the interrupt
+    TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA);
+}
+
+// interrupts must be disabled
+void TwiSlave::_stop(uint8_t result)
+{
+    _txResult = result;
+    _state = State::IDLE;
+    TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTO);
+}
+
+inline void TwiSlave::_masterLost()
+{
+    if (_state == State::MASTER_TX) {
+        _txResult = 4;
+    }
+}
+
+bool TwiSlave::_isr()
+{
+    ISR_STATS_SCOPE(TWI);
+    switch(TW_STATUS) {
+        // slave receiver
+        case TW_SR_SLA_ACK:
+        case TW_SR_GCALL_ACK:
+        case TW_SR_ARB_LOST_SLA_ACK:
+        case TW_SR_ARB_LOST_GCALL_ACK:
+            _masterLost();
+            _state = State::SLAVE_RX;
+            _generalCall = (TW_STATUS == TW_SR_GCALL_ACK || TW_STATUS == TW_SR_ARB_LOST_GCALL_ACK);
+            _rxLength = 0;
+            _rxCount = 0;
+            _reply(true);
+            break;
+        case TW_SR_DATA_ACK:
+        case TW_SR_GCALL_DATA_ACK: {
+                uint8_t data = TWDR;
+                if (_rxLength == 0 && _onReceiveByte && _onReceiveByte(data, _rxCount)) {
+                    // decoded
+                }
+                else if (_rxLength < kBufferLength) {
+                    _rxBuffer[_rxLength++] = data;
+                }
+                _rxCount++;
+                _reply(_rxLength < kBufferLength);
+            }
+            break;
+        case TW_SR_STOP:
+        // the buffer is full and the byte has been dropped. the master stops sending and the TWI is
+        // not addressed anymore, no TW_SR_STOP follows
+        case TW_SR_DATA_NACK:
+        case TW_SR_GCALL_DATA_NACK:
+            // release the bus and disable the interrupt
+            TWCR = _BV(TWEN) | _BV(TWEA) | _BV(TWINT);
+            return true;
+
+        // slave transmitter
+        case TW_ST_SLA_ACK:
+        case TW_ST_ARB_LOST_SLA_ACK:
+            _masterLost();
+            _state = State::SLAVE_TX;
+            _txPtr = nullptr;
+            _txRemaining = 0;
+            if (_onRequest) {
+                _request = true;
+                _onRequest();
+                _request = false;
+            }
+            // fallthrough
+        case TW_ST_DATA_ACK:
+            if (_txRemaining) {
+                TWDR = *_txPtr++;
+                _txRemaining--;
+            }
+            else {
+                TWDR = 0xff;
+            }
+            // NACK from the master or TWEA cleared after the last byte
+            _reply(_txRemaining != 0);
+            break;
+        case TW_ST_DATA_NACK:
+        case TW_ST_LAST_DATA:
+            _state = State::IDLE;
+            _reply(true);
+            break;
+
+        // master transmitter
+        case TW_START:
+        case TW_REP_START:
+            TWDR = (_address << 1) | TW_WRITE;
+            // clears TWSTA
+            _reply(true);
+            break;
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (_txRemaining) {
+                TWDR = *_txPtr++;
+                _txRemaining--;
+                _reply(true);
+            }
+            else {
+                _stop(0);
+            }
+            break;
+        case TW_MT_SLA_NACK:
+            _stop(2);
+            break;
+        case TW_MT_DATA_NACK:
+            _stop(3);
+            break;
+        case TW_MT_ARB_LOST:
+            // the TWI is not addressed and continues as slave
+            _masterLost();
+            _state = State::IDLE;
+            _reply(true);
+            break;
+
+        case TW_BUS_ERROR:
+            _masterLost();
+            _state = State::IDLE;
+            TWCR = _BV(TWEN) | _BV(TWIE) | _BV(TWEA) | _BV(TWINT) | _BV(TWSTO);
+            break;
+        default:
+            _reply(true);
+            break;
+    }
+    return false;
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// drop-in replacement for the Arduino Wire library (DIMMER_HAVE_TWI_SLAVE)
+//
+// the slave transmitter sends the data directly from the buffer passed to write() inside the onRequest()
+// callback instead of copying it into a 32 byte buffer. the master transmitter is only used for sending
+// events. transmit() sends the data from the TWI interrupt without blocking, endTransmission() waits for the
+// result. the environment must ignore the Wire library (lib_ignore = Wire)
+//
+// received bytes can be decoded one by one inside the interrupt with onReceiveByte(). bytes that are
+// not decoded are buffered and passed to onReceive() after the stop condition, which is called with
+// interrupts enabled. the TWI interrupt stays disabled and the next transaction is stretched until
+// onReceive() returns
+
+#pragma once
+
+#include <Arduino.h>
+
+#ifndef DIMMER_TWI_BUFFER_LENGTH
+#    define DIMMER_TWI_BUFFER_LENGTH 32
+#endif
+
+// I2C clock for the master transmitter
+#ifndef DIMMER_TWI_FREQUENCY
+#    define DIMMER_TWI_FREQUENCY 100000UL
+#endif
+
+class TwiSlave : public Stream {
+public:
+    using onReceiveCallback = void (*)(int);
+    using onRequestCallback = void (*)();
+    // index is the position of the byte in the transaction. return false to buffer this and all
+    // following bytes for onReceive()
+    using onReceiveByteCallback = bool (*)(uint8_t data, uint8_t index);
+
+    static constexpr uint8_t kBufferLength = DIMMER_TWI_BUFFER_LENGTH;
+    // transmitResult() while the transmission is in progress
+    static constexpr uint8_t kTransmitBusy = 0xff;
+
+    enum class State : uint8_t {
+        IDLE,
+        SLAVE_RX,
+        SLAVE_TX,
+        MASTER_TX,
+    };
+
+    void begin(uint8_t address);
+    void end();
+
+    void onReceive(onReceiveCallback callback) {
+        _onReceive = callback;
+    }
+    void onRequest(onRequestCallback callback) {
+        _onRequest = callback;
+    }
+    void onReceiveByte(onReceiveByteCallback callback) {
+        _onReceiveByte = callback;
+    }
+
+    // receive transactions sent to the general call address
+    void enableGeneralCall() {
+        TWAR |= _BV(TWGCE);
+    }
+    // inside onReceiveByte() and onReceive(), true if the transaction has been sent to the general call address
+    bool isGeneralCall() const {
+        return _generalCall;
+    }
+
+    // master transmitter, returns the same error codes as TwoWire::endTransmission()
+    void beginTransmission(uint8_t address);
+    uint8_t endTransmission(uint8_t sendStop = true);
+
+    // non-blocking master transmitter, returns false if the TWI is busy. the data is not copied and must not
+    // be modified until transmitResult() returns anything but kTransmitBusy
+    bool transmit(uint8_t address, const uint8_t *buffer, uint8_t length);
+    // result of the last transmission, 2 if the address has not been acknowledged, 3 for the data and 4 if
+    // the arbitration has been lost or the TWI has been addressed as slave before sending the start condition
+    uint8_t transmitResult() const {
+        return _txResult;
+    }
+
+    // inside the onRequest() callback, the data is not copied and must not be modified until the master
+    // has read it. multi byte values can change between two bytes if they are modified by an interrupt
+    using Print::write;
+    virtual size_t write(uint8_t data) override;
+    virtual size_t write(const uint8_t *buffer, size_t size) override;
+
+    virtual int available() override {
+        return _rxLength - _rxIndex;
+    }
+    virtual int read() override {
+        return _rxIndex < _rxLength ? _rxBuffer[_rxIndex++] : -1;
+    }
+    virtual int peek() override {
+        return _rxIndex < _rxLength ? _rxBuffer[_rxIndex] : -1;
+    }
+
+    // TWI_vect, returns true if onReceive() must be called
+    bool _isr();
+    // TWI_vect, calls onReceive() with interrupts enabled
+    void _receive();
+
+private:
+    void _reply(bool ack);
+    void _stop(uint8_t result);
+    void _masterLost();
+
+private:
+    onReceiveCallback _onReceive{nullptr};
+    onRequestCallback _onRequest{nullptr};
+    onReceiveByteCallback _onReceiveByte{nullptr};
+    volatile State _state{State::IDLE};
+    uint8_t _address{0};
+    uint8_t _rxBuffer[kBufferLength];
+    uint8_t _rxLength{0};
+    uint8_t _rxIndex{0};
+    // bytes received in the current transaction
+    uint8_t _rxCount{0};
+    bool _generalCall{false};
+    // endTransmission() or single bytes written in onRequest()
+    uint8_t _txBuffer[kBufferLength];
+    uint8_t _txLength{0};
+    // slave and master transmitter
+    const uint8_t *_txPtr{nullptr};
+    uint8_t _txRemaining{0};
+    volatile uint8_t _txResult{0};
+    // inside onRequest()
+    bool _request{false};
+};
+
+extern TwiSlave Wire;
@@ -0,0 +1,93 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if DIMMER_ZC_FILTER
+
+#include "dimmer.h"
+#include "zc_filter.h"
+
+using namespace Dimmer;
+
+static constexpr uint16_t kMinPulseTicks = Timer<1>::ticksPerMicrosecond * DIMMER_ZC_FILTER_MIN_PULSE_US;
+
+#if DIMMER_ZC_FILTER_VALID_EDGES
+    // DIMMER_ZC_INTERVAL_MAX_DEVIATION as 16 bit fraction, accept() runs in the ZC interrupt and must not use floating point math
+    static constexpr uint16_t kMaxDeviation = DIMMER_ZC_INTERVAL_MAX_DEVIATION * 65536.0 + 0.5;
+    // half wave at 45Hz
+    static_assert(static_cast<uint64_t>(F_CPU / 90) * kMaxDeviation <= UINT32_MAX, "period * kMaxDeviation overflows");
+#endif
+
+#if DIMMER_ZC_INTERRUPT_MODE == FALLING
+    static constexpr bool kZCActiveLevel = LOW;
+#else
+    static constexpr bool kZCActiveLevel = HIGH;
+#endif
+
+static inline void increment(uint8_t &counter)
+{
+    if (counter != 0xff) {
+        counter++;
+    }
+}
+
+void ZeroCrossingFilter::begin()
+{
+    _history = 0;
+    _synced = false;
+}
+
+inline bool ZeroCrossingFilter::_checkPulseWidth(uint16_t &latency)
+{
+    #if DIMMER_ZC_FILTER_MIN_PULSE_US
+        // returns immediately if the interrupt was executed after the min. pulse width
+        uint16_t start = TCNT1 - latency;
+        while ((latency = TCNT1 - start) < kMinPulseTicks) {
+            if ((DIMMER_SFR_ZC_STATE != 0) != kZCActiveLevel) {
+                return false;
+            }
+        }
+    #endif
+    return true;
+}
+
+bool ZeroCrossingFilter::accept(uint32_t ticks, uint16_t &latency, uint32_t period)
+{
+    if (_synced && ticks - _last < kBlankingCycles) {
+        increment(error_counters.zc_blanked);
+        return false;
+    }
+
+    if (!_checkPulseWidth(latency)) {
+        increment(error_counters.zc_pulse_width);
+        return false;
+    }
+
+    #if DIMMER_ZC_FILTER_VALID_EDGES
+        // same limit as FrequencyMeasurement::_calc_halfwave_min_max()
+        uint16_t limit = (period * kMaxDeviation) >> 16;
+        int32_t error = (ticks - _last) - period;
+        for(uint8_t i = 0; i < kMaxMissing && error > static_cast<int32_t>(period / 2); i++) {
+            error -= period;
+        }
+        bool valid = _synced && error >= -static_cast<int32_t>(limit) && error <= static_cast<int32_t>(limit);
+        if (valid || !_synced || error > 0) {
+            // a missing edge starts a new interval
+            _last = ticks;
+            _synced = true;
+        }
+        _history = ((_history << 1) | valid) & kEdgesMask;
+        if (!valid || __builtin_popcount(_history) < kValidEdges) {
+            increment(error_counters.zc_interval);
+            return false;
+        }
+    #else
+        _last = ticks;
+        _synced = true;
+    #endif
+    return true;
+}
+
+#endif
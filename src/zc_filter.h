@@ -0,0 +1,54 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// filter for the zero crossing signal (DIMMER_ZC_FILTER)
+//
+// LED drivers on the same circuit can produce bursts of spurious edges. each edge passes three checks before
+// zc_interrupt_handler() starts the half wave or updates the PLL
+//
+// - edges within DIMMER_ZC_FILTER_BLANKING_US after the last valid edge are ignored
+// - the signal must stay active for DIMMER_ZC_FILTER_MIN_PULSE_US, shorter spikes are ignored
+// - the interval to the last valid edge must match the length of the half wave. up to 2 missing edges are skipped,
+//   more start a new interval. the edge is accepted if it is valid and DIMMER_ZC_FILTER_VALID_EDGES of the last DIMMER_ZC_FILTER_EDGES edges
+//   were valid
+//
+// the rejected edges are counted per check in error_counters
+
+#pragma once
+
+#include <Arduino.h>
+#include "dimmer_def.h"
+
+namespace Dimmer {
+
+    class ZeroCrossingFilter {
+    public:
+        static constexpr uint32_t kBlankingCycles = microsecondsToClockCycles(DIMMER_ZC_FILTER_BLANKING_US);
+        static constexpr uint8_t kValidEdges = DIMMER_ZC_FILTER_VALID_EDGES;
+        static constexpr uint8_t kEdgesMask = (1U << DIMMER_ZC_FILTER_EDGES) - 1;
+        // missing edges between two valid edges
+        static constexpr uint8_t kMaxMissing = 2;
+
+        // the history of the edges is cleared
+        void begin();
+
+        // ticks          time of the edge in clock cycles (timer2)
+        // latency        timer1 ticks since the edge, the time waiting for the min. pulse width is added
+        // period         length of the half wave in clock cycles
+        //
+        // returns false if the edge must be ignored
+        bool accept(uint32_t ticks, uint16_t &latency, uint32_t period);
+
+    private:
+        bool _checkPulseWidth(uint16_t &latency);
+
+    private:
+        // time of the last valid edge
+        uint32_t _last;
+        // one bit per edge, 1 if the interval was valid
+        uint8_t _history;
+        bool _synced;
+    };
+
+}
@@ -0,0 +1,140 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+#include "dimmer_def.h"
+
+#if ENABLE_ZC_PREDICTION
+
+#include "dimmer.h"
+#include "zc_pll.h"
+
+using namespace Dimmer;
+
+// more missing zero crossings than this resets the phase
+static constexpr uint8_t kMaxMissed = 8;
+
+void ZeroCrossingPll::begin(uint32_t period)
+{
+    _period = period;
+    // same limit as FrequencyMeasurement::_calc_halfwave_min_max()
+    _maxPhaseError = (period >> kFractionBits) * DIMMER_ZC_INTERVAL_MAX_DEVIATION;
+    _phaseError = 0;
+    _avgPhaseError = _maxPhaseError;
+    _rejected = 0;
+    _missed = 0;
+    _lockCount = 0;
+    _synced = false;
+    #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+        _flywheelTotal = 0;
+    #endif
+}
+
+inline void ZeroCrossingPll::_advance()
+{
+    uint16_t fraction = _nextFraction + static_cast<uint8_t>(_period);
+    _next += (_period >> kFractionBits) + (fraction >> kFractionBits);
+    _nextFraction = fraction;
+    #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+        // first overflow after the max. phase error
+        _flywheelOverflow = (((_next + _maxPhaseError) / MeasureTimer::prescaler) >> 8) + 1;
+    #endif
+}
+
+ZeroCrossingPll::Result ZeroCrossingPll::update(uint32_t ticks, int16_t &offset)
+{
+    if (!_synced) {
+        // the first edge sets the phase
+        _synced = true;
+        _lockCount = 0;
+        #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+            _flywheelCount = 0;
+        #endif
+        _next = ticks;
+        _nextFraction = 0;
+        _advance();
+        offset = 0;
+        return Result::SYNC;
+    }
+
+    int32_t period = this->period();
+    int32_t error = ticks - _next;
+    if (error > period / 2) {
+        // skip the zero crossings without edge
+        uint8_t missed = 0;
+        do {
+            if (++missed > kMaxMissed) {
+                _missed += missed;
+                _synced = false;
+                return update(ticks, offset);
+            }
+            _advance();
+            error -= period;
+        } while (error > period / 2);
+        _missed += missed;
+    }
+
+    // the error can be up to half a period and must be checked before it is narrowed to 16 bit
+    uint32_t absError = error < 0 ? -error : error;
+    if (absError > _maxPhaseError) {
+        _rejected++;
+        _lockCount = 0;
+        return Result::REJECTED;
+    }
+
+    _phaseError = error;
+    _avgPhaseError += static_cast<int16_t>(static_cast<uint16_t>(absError) - _avgPhaseError) >> kAverageShift;
+    if (_lockCount < 0xff) {
+        _lockCount++;
+    }
+
+    // move the predicted zero crossing towards the edge and adjust the length of the half wave
+    int16_t correction = static_cast<int16_t>(error) >> kPhaseShift;
+    offset = error - correction;
+    _next += correction;
+    _period += error >> (kFrequencyShift - kFractionBits);
+    _period = std::clamp<uint32_t>(_period, static_cast<uint32_t>(kMinCyclesPerHalfWave) << kFractionBits, static_cast<uint32_t>(kMaxCyclesPerHalfWave) << kFractionBits);
+    _advance();
+    #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+        _flywheelCount = 0;
+    #endif
+    return Result::VALID;
+}
+
+#if DIMMER_ZC_FLYWHEEL_HALFWAVES
+
+    bool ZeroCrossingPll::flywheel(uint32_t ticks, int16_t &offset)
+    {
+        if (_flywheelCount >= DIMMER_ZC_FLYWHEEL_HALFWAVES) {
+            // the next edge sets the phase again
+            _synced = false;
+            _lockCount = 0;
+            return false;
+        }
+        _flywheelCount++;
+        _flywheelTotal++;
+        _lockCount = 0;
+        offset = ticks - _next;
+        _advance();
+        return true;
+    }
+
+#endif
+
+void ZeroCrossingPll::get(dimmer_zc_pll_t &pll) const
+{
+    pll.period = _period;
+    pll.phase_error = _phaseError;
+    pll.avg_phase_error = _avgPhaseError;
+    pll.rejected = _rejected;
+    pll.missed = _missed;
+    pll.lock_count = _lockCount;
+    pll.locked = locked();
+    #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+        pll.flywheel = _flywheelTotal;
+    #else
+        pll.flywheel = 0;
+    #endif
+}
+
+#endif
@@ -0,0 +1,112 @@
+/**
+ * Author: sascha_lammers@gmx.de
+ */
+
+// digital PLL that tracks the zero crossing (ENABLE_ZC_PREDICTION)
+//
+// the PLL predicts the time of the next zero crossing from the filtered length of the half wave. each edge
+// of the ZC signal is compared with the prediction. the phase error corrects the phase of the prediction
+// by 1 / 2^DIMMER_ZC_PLL_PHASE_SHIFT and the length of the half wave by 1 / 2^DIMMER_ZC_PLL_FREQUENCY_SHIFT.
+// the default gains are critically damped and settle within ~50 half waves
+//
+// the half wave is started relative to the filtered zero crossing instead of the edge, which removes most
+// of the jitter of the ZC signal. edges with a phase error of more than DIMMER_ZC_INTERVAL_MAX_DEVIATION
+// are not used. missing edges are skipped
+//
+// if an edge is missing or has been rejected, the flywheel starts the half wave from the prediction for up to
+// DIMMER_ZC_FLYWHEEL_HALFWAVES half waves. TIMER2_OVF_vect checks if the predicted zero crossing plus the max.
+// phase error has passed without a valid edge. if there is no valid edge after that, the dimmer stops until
+// the next edge, which sets the phase again. rejected edges do not start the half wave while the flywheel
+// is enabled
+//
+// all calculations are done with integers inside the ZC interrupt. the length of the half wave has 8 bit
+// fraction
+
+#pragma once
+
+#include <Arduino.h>
+#include "dimmer_def.h"
+#include "dimmer_reg_mem.h"
+
+namespace Dimmer {
+
+    class ZeroCrossingPll {
+    public:
+        static constexpr uint8_t kFractionBits = 8;
+        static constexpr uint8_t kPhaseShift = DIMMER_ZC_PLL_PHASE_SHIFT;
+        static constexpr uint8_t kFrequencyShift = DIMMER_ZC_PLL_FREQUENCY_SHIFT;
+        // consecutive edges with an average phase error below DIMMER_ZC_PLL_LOCK_THRESHOLD_US to report the lock
+        static constexpr uint8_t kLockCount = 16;
+        static constexpr uint16_t kLockThreshold = microsecondsToClockCycles(DIMMER_ZC_PLL_LOCK_THRESHOLD_US);
+        // the average phase error is filtered over 2^kAverageShift edges
+        static constexpr uint8_t kAverageShift = 4;
+
+        static_assert(kFrequencyShift >= kFractionBits, "DIMMER_ZC_PLL_FREQUENCY_SHIFT too low");
+
+        enum class Result : uint8_t {
+            REJECTED,
+            // first edge, which sets the phase
+            SYNC,
+            VALID,
+        };
+
+        // period         length of the half wave in clock cycles with kFractionBits
+        void begin(uint32_t period);
+
+        // ticks          time of the edge in clock cycles (timer2)
+        // offset         offset of the edge to the filtered zero crossing in clock cycles
+        Result update(uint32_t ticks, int16_t &offset);
+
+        #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+            // TIMER2_OVF_vect, returns true if the flywheel must be called
+            bool isFlywheelDue(uint16_t overflow) const {
+                return _synced && overflow == _flywheelOverflow;
+            }
+
+            // ticks          current time in clock cycles (timer2)
+            // offset         clock cycles since the predicted zero crossing
+            //
+            // returns false if there has not been a valid edge for DIMMER_ZC_FLYWHEEL_HALFWAVES half waves
+            bool flywheel(uint32_t ticks, int16_t &offset);
+        #endif
+
+        // length of the half wave in clock cycles
+        uint32_t period() const {
+            return _period >> kFractionBits;
+        }
+
+        bool locked() const {
+            return _lockCount >= kLockCount && _avgPhaseError < kLockThreshold;
+        }
+
+        // interrupts must be disabled
+        void get(dimmer_zc_pll_t &pll) const;
+
+    private:
+        // move the prediction to the next zero crossing
+        void _advance();
+
+    private:
+        // time of the next zero crossing in clock cycles
+        uint32_t _next;
+        uint8_t _nextFraction;
+        // length of the half wave, fixed point
+        uint32_t _period;
+        // edges with a higher phase error are rejected
+        uint16_t _maxPhaseError;
+        int16_t _phaseError;
+        uint16_t _avgPhaseError;
+        uint16_t _rejected;
+        uint16_t _missed;
+        uint8_t _lockCount;
+        bool _synced;
+        #if DIMMER_ZC_FLYWHEEL_HALFWAVES
+            // timer2 overflow after the max. phase error of the next zero crossing
+            uint16_t _flywheelOverflow;
+            // half waves started by the flywheel since the last valid edge
+            uint8_t _flywheelCount;
+            uint16_t _flywheelTotal;
+        #endif
+    };
+
+}